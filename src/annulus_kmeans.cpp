@@ -9,6 +9,7 @@
 #include <cmath>
 #include <numeric>
 #include <algorithm>
+#include <limits>
 
 void AnnulusKmeans::free() {
     HamerlyKmeans::free();
@@ -33,7 +34,7 @@ int AnnulusKmeans::runThread(int threadId, int maxIterations) {
         update_s(threadId);
         synchronizeAllThreads();
 
-        if (threadId == 0) {
+        if (threadId == 0 && ! centerIndex) {
             // compute the inter-center distances, keeping only the closest distances
             sort_means_by_norm();
         }
@@ -68,27 +69,43 @@ int AnnulusKmeans::runThread(int threadId, int maxIterations) {
 
             double beta = std::max(lower[i], upper[i]);
 
-            std::pair<double, int>* begin = std::lower_bound(cOrder, cOrder + k, std::make_pair(xNorm[i] - beta, k));
-            std::pair<double, int>* end = std::lower_bound(begin, cOrder + k, std::make_pair(xNorm[i] + beta, k));
-
-            for (std::pair<double, int>* jp = begin; jp != end; ++jp) {
-                if (jp->second == closest) continue;
-
-                double dist2 = pointCenterDist2(i, jp->second);
-                if (dist2 <= u2) {
-                    if (dist2 == u2) {
-                        if (jp->second < closest) closest = jp->second;
-                    } else {
-                        l2 = u2;
-                        u2 = dist2;
-                        guard[i] = closest;
-                        closest = jp->second;
+            if (centerIndex) {
+                // the two closest centers are within distance beta
+                std::pair<double, int> near[2];
+                int found = find_nearest_centers(i, 2, beta * beta, near, threadId);
+                if (found < std::min(2, k)) {
+                    found = find_nearest_centers(i, 2, std::numeric_limits<double>::max(), near, threadId);
+                }
+                u2 = near[0].first;
+                closest = near[0].second;
+                l2 = std::numeric_limits<double>::max();
+                if (found > 1) {
+                    l2 = near[1].first;
+                    guard[i] = near[1].second;
+                }
+            } else {
+                std::pair<double, int>* begin = std::lower_bound(cOrder, cOrder + k, std::make_pair(xNorm[i] - beta, k));
+                std::pair<double, int>* end = std::lower_bound(begin, cOrder + k, std::make_pair(xNorm[i] + beta, k));
+
+                for (std::pair<double, int>* jp = begin; jp != end; ++jp) {
+                    if (jp->second == closest) continue;
+
+                    double dist2 = pointCenterDist2(i, jp->second);
+                    if (dist2 <= u2) {
+                        if (dist2 == u2) {
+                            if (jp->second < closest) closest = jp->second;
+                        } else {
+                            l2 = u2;
+                            u2 = dist2;
+                            guard[i] = closest;
+                            closest = jp->second;
+                        }
+                    } else if (dist2 < l2) {
+                        // we must reduce the lower bound on the distance to the
+                        // *second* closest center to x[i]
+                        l2 = dist2;
+                        guard[i] = jp->second;
                     }
-                } else if (dist2 < l2) {
-                    // we must reduce the lower bound on the distance to the
-                    // *second* closest center to x[i]
-                    l2 = dist2;
-                    guard[i] = jp->second;
                 }
             }
 
@@ -111,6 +128,7 @@ int AnnulusKmeans::runThread(int threadId, int maxIterations) {
         if (threadId == 0) {
             int furthestMovingCenter = move_centers();
             converged = (0.0 == centerMovement[furthestMovingCenter]);
+            update_center_index();
         }
 
         synchronizeAllThreads();
@@ -143,6 +161,15 @@ void AnnulusKmeans::initialize(Dataset const *aX, unsigned short aK, unsigned sh
     }
 }
 
+void AnnulusKmeans::seed_bounds(std::pair<double, int> const *nearest, int m, int startNdx, int endNdx) {
+    HamerlyKmeans::seed_bounds(nearest, m, startNdx, endNdx);
+    if (m > 1) {
+        for (int i = startNdx; i < endNdx; ++i) {
+            guard[i] = nearest[i * m + 1].second;
+        }
+    }
+}
+
 void AnnulusKmeans::sort_means_by_norm() {
     // sort the centers by their norms
     for (int c1 = 0; c1 < k; ++c1) {
@@ -22,13 +22,17 @@ class AnnulusKmeans : public HamerlyKmeans {
         AnnulusKmeans() : xNorm(NULL), cOrder(NULL), guard(NULL) {}
         virtual ~AnnulusKmeans() { free(); }
         virtual void free();
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
-        virtual std::string getName() const { return "annulus"; }
+        virtual std::string getName() const { return useCenterIndex ? "annulus+index" : "annulus"; }
 
     protected:
         virtual int runThread(int threadId, int maxIterations);
         void sort_means_by_norm();
 
+        // Also seeds the guard with the second-nearest initial center.
+        virtual void seed_bounds(std::pair<double, int> const *nearest, int m, int startNdx, int endNdx);
+
         // The norm of each point.
         double *xNorm;
 
@@ -0,0 +1,298 @@
+#!/usr/bin/env python3
+
+'''Benchmarks the algorithms of driver-experiment on synthetic datasets.
+
+For each kind of dataset and each combination of n, d and k, the dataset is
+made by driver-generate (once; it is kept in the output directory). Every
+algorithm is then run on it, from the same k-means++ initial centers, with each
+number of threads, each run in its own process so that its peak memory is its
+own. The time (the fastest of the repeats), iterations, peak memory and SSE
+come from the threaded driver, and the number of distance calculations from a
+single-threaded run of a driver built with COUNT_DISTANCES (the counts are not
+exact with threads). Times include any setup the driver reports on its own
+line, such as building kernel features.
+
+The results go to results.csv and results.json in the output directory. Given
+a baseline (the results.json of an earlier run), each result is compared with
+the baseline result for the same dataset, algorithm and threads, and flagged
+if it is slower, uses more distance calculations or memory, or finds a
+different number of iterations or SSE. The exit status is 1 if any result is
+flagged.
+
+'make bench' builds the drivers and runs this script; see the Makefile.
+'''
+
+### Imports ###
+
+import argparse
+import csv
+import json
+import os
+import subprocess
+import sys
+
+### Constants ###
+
+# The fields of each result, in the order of the CSV columns
+FIELDS = ['kind', 'n', 'd', 'k', 'seed', 'algorithm', 'name', 'threads',
+          'iterations', 'cpu_secs', 'wall_secs', 'mem_mb', 'sse', 'distances']
+
+# The fields that identify a result, for comparison with the baseline
+KEY_FIELDS = ['kind', 'n', 'd', 'k', 'seed', 'algorithm', 'threads']
+
+KINDS = ['gaussian', 'uniform', 'anisotropic', 'heavytailed']
+
+# The algorithms whose cost grows with n^2, which are only run on small
+# datasets
+KERNEL_ALGORITHMS = ['kernel', 'elkan_kernel', 'hamerly_kernel']
+
+### Functions ###
+
+
+def algorithms(path, n, k, tau):
+    '''Return the algorithms to run on the dataset at path as a list of
+    (label, commands) pairs, where commands are the driver commands that run
+    it.
+    '''
+
+    drake_bounds = min(k - 1, max(2, k // 8))
+    result = [
+        ('lloyd', ['lloyd']),
+        ('hamerly', ['hamerly']),
+        ('hamerly+index', ['centerindex on', 'hamerly']),
+        ('annulus', ['annulus']),
+        ('annulus+index', ['centerindex on', 'annulus']),
+        ('elkan', ['elkan']),
+        ('drake', ['drake {}'.format(drake_bounds)]),
+        ('adaptive', ['adaptive']),
+        ('adaptive+index', ['centerindex on', 'adaptive']),
+        ('compare', ['compare']),
+        ('sort', ['sort']),
+        ('heap', ['heap']),
+        ('kdtree', ['kdtree']),
+        ('minibatch', ['minibatch {} 10'.format(min(n, 1000))]),
+        ('stream', ['stream {} {} {} double read'.format(
+            path, max(1000, n // 10), k)]),
+        ('kernel', ['kernel gaussian {}'.format(tau)]),
+        ('elkan_kernel', ['elkan_kernel gaussian {}'.format(tau)]),
+        ('hamerly_kernel', ['hamerly_kernel gaussian {}'.format(tau)]),
+        ('nystrom', ['kernel nystrom {} hamerly gaussian {}'.format(
+            min(n, 100), tau)]),
+        ('fourier', ['kernel fourier 256 1 hamerly gaussian {}'.format(tau)]),
+    ]
+    if k < 3:
+        result = [a for a in result if a[0] != 'drake']
+    return result
+
+
+def generate(generator, kind, n, d, k, seed, path):
+    '''Write the dataset to path with driver-generate, unless it exists.'''
+
+    if os.path.exists(path):
+        return
+    with open(path + '.tmp', 'w') as f:
+        subprocess.run([generator, kind, str(n), str(d), str(k), str(seed)],
+                       stdout=f, check=True)
+    os.rename(path + '.tmp', path)
+
+
+def run_driver(driver, path, k, seed, threads, commands):
+    '''Run the commands with driver-experiment on the dataset at path, and
+    return its results (iterations, cpu and wall seconds, MB, SSE and
+    distances, where known) summed over the lines it reports, or None if it
+    reports none.
+    '''
+
+    script = ['dataset ' + path, 'seed {}'.format(seed),
+              'initialize {} kpp'.format(k), 'threads {}'.format(threads)]
+    script += commands + ['quit']
+    proc = subprocess.run([driver], input='\n'.join(script) + '\n',
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True)
+
+    result = None
+    for line in proc.stdout.splitlines():
+        fields = [f.strip() for f in line.split('\t')]
+        if len(fields) < 6 or fields[0] == 'algorithm':
+            continue
+        try:
+            cpu, wall, mem = float(fields[3]), float(fields[4]), \
+                float(fields[5])
+        except ValueError:
+            continue
+        if result is None:
+            result = {'iterations': None, 'cpu_secs': 0.0, 'wall_secs': 0.0,
+                      'mem_mb': 0.0, 'sse': None, 'distances': None}
+
+        # the clustering line has the iterations; setup lines have '-'
+        result['name'] = fields[0]
+        result['cpu_secs'] += cpu
+        result['wall_secs'] += wall
+        result['mem_mb'] = max(result['mem_mb'], mem)
+        if fields[1].isdigit():
+            result['iterations'] = int(fields[1])
+        extra = [float(f) for f in fields[6:] if f not in ('', '-')]
+        if len(extra) >= 1:
+            result['sse'] = extra[0]
+        if len(extra) >= 2:
+            result['distances'] = int(extra[1])
+
+    if result is None:
+        sys.stderr.write('{} failed on {}: {}\n'.format(
+            ' / '.join(commands), path, proc.stderr.strip()))
+    return result
+
+
+def compare(results, baseline, tolerance, min_seconds):
+    '''Return the flagged results as (result, reasons) pairs.'''
+
+    def key(r):
+        return tuple(r[f] for f in KEY_FIELDS)
+
+    base = dict((key(r), r) for r in baseline)
+    flagged = []
+    for r in results:
+        b = base.get(key(r))
+        if b is None:
+            continue
+
+        reasons = []
+        if r['wall_secs'] > b['wall_secs'] * (1 + tolerance) and \
+                r['wall_secs'] - b['wall_secs'] > min_seconds:
+            reasons.append('wall {:.4g}s vs {:.4g}s'.format(
+                r['wall_secs'], b['wall_secs']))
+        if r['distances'] is not None and b['distances'] is not None and \
+                r['distances'] > b['distances'] * (1 + tolerance):
+            reasons.append('distances {} vs {}'.format(
+                r['distances'], b['distances']))
+        if r['mem_mb'] > b['mem_mb'] * (1 + tolerance) and \
+                r['mem_mb'] - b['mem_mb'] > 1.0:
+            reasons.append('memory {:.4g}MB vs {:.4g}MB'.format(
+                r['mem_mb'], b['mem_mb']))
+        if r['iterations'] != b['iterations']:
+            reasons.append('iterations {} vs {}'.format(
+                r['iterations'], b['iterations']))
+        if r['sse'] is not None and b['sse'] is not None and \
+                abs(r['sse'] - b['sse']) > 1e-6 * abs(b['sse']):
+            reasons.append('sse {:.10g} vs {:.10g}'.format(r['sse'], b['sse']))
+        if reasons:
+            flagged.append((r, reasons))
+    return flagged
+
+
+def int_list(text):
+    return [int(v) for v in text.split(',')]
+
+
+### Main ###
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Benchmark the algorithms of driver-experiment on '
+                    'synthetic datasets.')
+    parser.add_argument('--driver', default='bench-build/driver-experiment',
+                        help='driver-experiment built with threads')
+    parser.add_argument('--count-driver',
+                        default='bench-build/driver-experiment-count',
+                        help='driver-experiment built with COUNT_DISTANCES')
+    parser.add_argument('--generator', default='./driver-generate')
+    parser.add_argument('--out', default='bench-build/results',
+                        help='directory for the datasets and results')
+    parser.add_argument('--kinds', default=','.join(KINDS))
+    parser.add_argument('--n', type=int_list, default=[20000])
+    parser.add_argument('--d', type=int_list, default=[8])
+    parser.add_argument('--k', type=int_list, default=[50])
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--threads', type=int_list, default=[1, 2, 4])
+    parser.add_argument('--algorithms', default='',
+                        help='comma-separated labels to run (default all)')
+    parser.add_argument('--repeat', type=int, default=1,
+                        help='runs per result, keeping the fastest')
+    parser.add_argument('--tau', type=float, default=2.0,
+                        help='bandwidth of the gaussian kernel')
+    parser.add_argument('--kernel-max-n', type=int, default=5000,
+                        help='largest n to run exact kernel k-means on')
+    parser.add_argument('--baseline', help='results.json of an earlier run')
+    parser.add_argument('--tolerance', type=float, default=0.1,
+                        help='relative slowdown (or growth) to flag')
+    parser.add_argument('--min-seconds', type=float, default=0.05,
+                        help='smallest slowdown to flag, in seconds')
+    args = parser.parse_args()
+
+    kinds = args.kinds.split(',')
+    for kind in kinds:
+        if kind not in KINDS:
+            parser.error('unknown kind of dataset: ' + kind)
+    selected = set(args.algorithms.split(',')) if args.algorithms else None
+
+    data_dir = os.path.join(args.out, 'data')
+    os.makedirs(data_dir, exist_ok=True)
+
+    results = []
+    for kind in kinds:
+        for n in args.n:
+            for d in args.d:
+                for k in args.k:
+                    path = os.path.join(data_dir, '{}-{}-{}-{}-{}.txt'.format(
+                        kind, n, d, k, args.seed))
+                    generate(args.generator, kind, n, d, k, args.seed, path)
+
+                    for label, commands in algorithms(path, n, k, args.tau):
+                        if selected is not None and label not in selected:
+                            continue
+                        if label in KERNEL_ALGORITHMS and n > args.kernel_max_n:
+                            continue
+
+                        counted = run_driver(args.count_driver, path, k,
+                                             args.seed, 1, commands)
+                        for threads in args.threads:
+                            best = None
+                            for _ in range(args.repeat):
+                                r = run_driver(args.driver, path, k, args.seed,
+                                               threads, commands)
+                                if r is not None and (best is None or
+                                        r['wall_secs'] < best['wall_secs']):
+                                    best = r
+                            if best is None:
+                                continue
+
+                            best.update(kind=kind, n=n, d=d, k=k,
+                                        seed=args.seed, algorithm=label,
+                                        threads=threads)
+                            if counted is not None:
+                                best['distances'] = counted['distances']
+                            results.append(best)
+                            print('{kind:>12} n={n} d={d} k={k} '
+                                  '{algorithm:>15} threads={threads} '
+                                  'iters={iterations} wall={wall_secs:.4g}s '
+                                  'mem={mem_mb:.4g}MB sse={sse} '
+                                  'distances={distances}'.format(**best))
+                            sys.stdout.flush()
+
+    with open(os.path.join(args.out, 'results.csv'), 'w') as f:
+        writer = csv.DictWriter(f, fieldnames=FIELDS)
+        writer.writeheader()
+        for r in results:
+            writer.writerow(dict((field, r[field]) for field in FIELDS))
+    with open(os.path.join(args.out, 'results.json'), 'w') as f:
+        json.dump({'results': [dict((field, r[field]) for field in FIELDS)
+                               for r in results]}, f, indent=1)
+    print('wrote {} results to {}'.format(len(results), args.out))
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)['results']
+        flagged = compare(results, baseline, args.tolerance, args.min_seconds)
+        for r, reasons in flagged:
+            print('REGRESSION: {kind} n={n} d={d} k={k} {algorithm} '
+                  'threads={threads}: '.format(**r) + '; '.join(reasons))
+        print('{} of {} results flagged against {}'.format(
+            len(flagged), len(results), args.baseline))
+        if flagged:
+            return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,261 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "center_index.h"
+#include "general_functions.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sched.h>
+#include <utility>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
+
+CenterIndex::CenterIndex(Dataset const &aCenters, int maxNeighbors) {
+    centers = new Dataset(aCenters);
+    k = centers->n;
+    d = centers->d;
+
+    centerNorm = new double[k];
+    std::pair<double, int> *ring = new std::pair<double, int>[k];
+    for (int j = 0; j < k; ++j) {
+        centerNorm[j] = 0.0;
+        for (int dim = 0; dim < d; ++dim) {
+            centerNorm[j] += (*centers)(j, dim) * (*centers)(j, dim);
+        }
+        centerNorm[j] = sqrt(centerNorm[j]);
+        ring[j] = std::make_pair(centerNorm[j], j);
+    }
+    std::sort(ring, ring + k);
+    ringCenter = new int[k];
+    ringNorm = new double[k];
+    for (int r = 0; r < k; ++r) {
+        ringNorm[r] = ring[r].first;
+        ringCenter[r] = ring[r].second;
+    }
+    delete [] ring;
+
+    numNeighbors = (maxNeighbors > 0) ? std::min(maxNeighbors, k - 1) : k - 1;
+    neighborNdx = new int[k * numNeighbors];
+    neighborDist = new double[k * numNeighbors];
+    std::pair<double, int> *order = new std::pair<double, int>[k];
+    for (int j = 0; j < k; ++j) {
+        int m = 0;
+        for (int j2 = 0; j2 < k; ++j2) {
+            if (j2 != j) {
+                order[m++] = std::make_pair(sqrt(distance2(centers->data + j * d, centers->data + j2 * d, d)), j2);
+            }
+        }
+        std::partial_sort(order, order + numNeighbors, order + m);
+        for (int q = 0; q < numNeighbors; ++q) {
+            neighborDist[j * numNeighbors + q] = order[q].first;
+            neighborNdx[j * numNeighbors + q] = order[q].second;
+        }
+    }
+    delete [] order;
+
+    // Choose about sqrt(k) pivots spread out over the centers, by
+    // farthest-first traversal from center 0.
+    numPivots = std::max(1, (int)ceil(sqrt((double)k)));
+    pivot = new int[numPivots];
+    double *pivotDist2 = new double[k];
+    std::fill(pivotDist2, pivotDist2 + k, std::numeric_limits<double>::max());
+    pivot[0] = 0;
+    for (int p = 1; p < numPivots; ++p) {
+        int farthest = 0;
+        for (int j = 0; j < k; ++j) {
+            double d2 = distance2(centers->data + j * d, centers->data + pivot[p - 1] * d, d);
+            pivotDist2[j] = std::min(pivotDist2[j], d2);
+            if (pivotDist2[j] > pivotDist2[farthest]) {
+                farthest = j;
+            }
+        }
+        pivot[p] = farthest;
+    }
+    delete [] pivotDist2;
+}
+
+CenterIndex::~CenterIndex() {
+    delete centers;
+    delete [] centerNorm;
+    delete [] ringCenter;
+    delete [] ringNorm;
+    delete [] neighborNdx;
+    delete [] neighborDist;
+    delete [] pivot;
+}
+
+void CenterIndex::offer(double const *xp, double xNorm, double slack, int j, double *best2, double *best, int *bestNdx) const {
+    if (fabs(xNorm - centerNorm[j]) > *best + slack) {
+        return;
+    }
+    // compare squared distances, as assign() does
+    double dist2 = distance2(xp, centers->data + j * d, d);
+    if (dist2 < *best2 || (dist2 == *best2 && j < *bestNdx)) {
+        *best2 = dist2;
+        *best = sqrt(dist2);
+        *bestNdx = j;
+    }
+}
+
+int CenterIndex::nearest(double const *xp, double *dist) const {
+    double xNorm = 0.0;
+    for (int dim = 0; dim < d; ++dim) {
+        xNorm += xp[dim] * xp[dim];
+    }
+    xNorm = sqrt(xNorm);
+
+    // start from the closest pivot
+    double best2 = std::numeric_limits<double>::max();
+    double best = std::numeric_limits<double>::max();
+    int bestNdx = k;
+    for (int p = 0; p < numPivots; ++p) {
+        offer(xp, xNorm, 0.0, pivot[p], &best2, &best, &bestNdx);
+    }
+
+    // The bounds are loosened by the rounding error they may have, so that
+    // the result is the same as comparing every center.
+    double slack = 1e-12 * (xNorm + best);
+
+    // Scan the neighbors of the closest center so far that may be closer;
+    // move to any closer one found and start again from it.
+    bool exhausted = false;
+    for (int c = k; c != bestNdx; ) {
+        c = bestNdx;
+        double cDist = best;
+        int const *ndx = neighborNdx + c * numNeighbors;
+        double const *nd = neighborDist + c * numNeighbors;
+        int q = 0;
+        for (; q < numNeighbors && nd[q] <= cDist + best + slack && c == bestNdx; ++q) {
+            offer(xp, xNorm, slack, ndx[q], &best2, &best, &bestNdx);
+        }
+        exhausted = (q == numNeighbors && q < k - 1);
+    }
+
+    // If the list ran out before ruling out the other centers, scan the
+    // centers with norms within best of that of x.
+    if (exhausted) {
+        int r = std::lower_bound(ringNorm, ringNorm + k, xNorm) - ringNorm;
+        for (int lo = r - 1; lo >= 0 && xNorm - ringNorm[lo] <= best + slack; --lo) {
+            offer(xp, xNorm, slack, ringCenter[lo], &best2, &best, &bestNdx);
+        }
+        for (int hi = r; hi < k && ringNorm[hi] - xNorm <= best + slack; ++hi) {
+            offer(xp, xNorm, slack, ringCenter[hi], &best2, &best, &bestNdx);
+        }
+    }
+
+    if (dist) {
+        *dist = best;
+    }
+    return bestNdx;
+}
+
+struct CenterIndexThreadInfo {
+    CenterIndex const *index;
+    Dataset const *x;
+    unsigned short *labels;
+    double *dist;
+    int threadId, numThreads;
+    #ifdef USE_THREADS
+    pthread_t pthread_id;
+    #endif
+};
+
+static void *center_index_runner(void *args) {
+    CenterIndexThreadInfo *ti = (CenterIndexThreadInfo *)args;
+    Dataset const &x = *ti->x;
+    int startNdx = (int)((long long)x.n * ti->threadId / ti->numThreads);
+    int endNdx = (int)((long long)x.n * (ti->threadId + 1) / ti->numThreads);
+    for (int i = startNdx; i < endNdx; ++i) {
+        ti->labels[i] = ti->index->nearest(x.data + i * x.d, ti->dist ? ti->dist + i : NULL);
+    }
+    return NULL;
+}
+
+void CenterIndex::nearest(Dataset const &x, unsigned short *labels, double *dist, int numThreads) const {
+    #ifdef USE_THREADS
+    int threads = std::max(1, std::min(numThreads, x.n));
+    #else
+    int threads = 1;
+    #endif
+    CenterIndexThreadInfo *info = new CenterIndexThreadInfo[threads];
+    for (int t = 0; t < threads; ++t) {
+        info[t].index = this;
+        info[t].x = &x;
+        info[t].labels = labels;
+        info[t].dist = dist;
+        info[t].threadId = t;
+        info[t].numThreads = threads;
+    }
+
+    #ifdef USE_THREADS
+    for (int t = 0; t < threads; ++t) {
+        pthread_create(&info[t].pthread_id, NULL, center_index_runner, &info[t]);
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(info[t].pthread_id, NULL);
+    }
+    #else
+    center_index_runner(&info[0]);
+    #endif
+
+    delete [] info;
+}
+
+CenterIndexServer::CenterIndexServer(CenterIndex *initial) {
+    slots[0].index.store(initial);
+    slots[0].readers.store(0);
+    slots[1].index.store(NULL);
+    slots[1].readers.store(0);
+    current.store(0);
+}
+
+CenterIndexServer::~CenterIndexServer() {
+    delete slots[0].index.load();
+    delete slots[1].index.load();
+}
+
+int CenterIndexServer::acquire() const {
+    // After registering as a reader of a slot, make sure it is still the
+    // current one; otherwise a swap may be about to delete its index.
+    while (true) {
+        int slot = current.load();
+        slots[slot].readers.fetch_add(1);
+        if (current.load() == slot) {
+            return slot;
+        }
+        slots[slot].readers.fetch_sub(1);
+    }
+}
+
+void CenterIndexServer::swap(CenterIndex *index) {
+    int old = current.load();
+    int next = 1 - old;
+
+    // The other slot has been empty since the last swap finished, and only
+    // readers that will back out (in acquire()) can be registered on it.
+    slots[next].index.store(index);
+    current.store(next);
+
+    while (slots[old].readers.load() > 0) {
+        sched_yield();
+    }
+    delete slots[old].index.exchange(NULL);
+}
+
+int CenterIndexServer::nearest(double const *xp, double *dist) const {
+    int slot = acquire();
+    int label = get(slot)->nearest(xp, dist);
+    release(slot);
+    return label;
+}
+
+void CenterIndexServer::nearest(Dataset const &x, unsigned short *labels, double *dist, int numThreads) const {
+    int slot = acquire();
+    get(slot)->nearest(x, labels, dist, numThreads);
+    release(slot);
+}
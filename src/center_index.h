@@ -0,0 +1,125 @@
+#ifndef CENTER_INDEX_H
+#define CENTER_INDEX_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * CenterIndex answers "which center is closest to this vector" for a fixed,
+ * trained set of centers (e.g. from getCenters()), for serving lookups after
+ * training. A query is exact, but usually computes few distances:
+ *  - it starts from the closest of about sqrt(k) pivot centers, which are
+ *    spread out over the centers;
+ *  - each center keeps its nearest other centers sorted by distance (as in
+ *    SortKmeans). The query scans the list of the closest center c found so
+ *    far only while d(c, c') <= d(x, c) + (the best distance so far), since
+ *    otherwise d(x, c') >= d(c, c') - d(x, c) rules c' out; it moves to any
+ *    closer center it finds, and stops once a scan finds none;
+ *  - the norms of the centers are precomputed, and a center c' is skipped
+ *    without computing its distance if |norm(x) - norm(c')| exceeds the best
+ *    distance so far.
+ * If a (truncated) neighbor list runs out first, the query falls back to
+ * scanning the centers sorted by norm (the rings of AnnulusKmeans) whose
+ * norms are close enough to its own. Distances are computed as in assign(),
+ * which gives the same results.
+ *
+ * CenterIndexServer holds the index currently being served, and lets a newly
+ * trained one be swapped in while queries run: queries never lock, and the old
+ * index is deleted once the queries using it have finished.
+ */
+
+#include "dataset.h"
+#include <atomic>
+
+class CenterIndex {
+    public:
+        // Index a copy of the given centers. Each center keeps its
+        // maxNeighbors nearest other centers (or all of them, if not
+        // positive), using 12 bytes per neighbor.
+        CenterIndex(Dataset const &aCenters, int maxNeighbors = 64);
+        ~CenterIndex();
+
+        // Return the closest center to the point xp (of dimension d), with
+        // ties going to the lower index; if dist is not NULL, also store the
+        // distance to it.
+        int nearest(double const *xp, double *dist = NULL) const;
+
+        // Find the closest center to each record of x (as above), using
+        // numThreads threads. If dist is not NULL, also store the distances.
+        void nearest(Dataset const &x, unsigned short *labels, double *dist = NULL, int numThreads = 1) const;
+
+        int getK() const { return k; }
+        int getD() const { return d; }
+        Dataset const *getCenters() const { return centers; }
+
+    private:
+        // Check center j against the point xp, unless its norm rules it out
+        // (by more than slack); best2 and best are the squared and plain
+        // distances to the closest center so far, bestNdx.
+        void offer(double const *xp, double xNorm, double slack, int j, double *best2, double *best, int *bestNdx) const;
+
+        Dataset *centers;
+        int k, d;
+
+        // The norm of each center.
+        double *centerNorm;
+
+        // The centers in order of norm, and their norms.
+        int *ringCenter;
+        double *ringNorm;
+
+        // The nearest other centers to center j, in order of distance, are
+        // neighborNdx[j * numNeighbors] ... (and neighborDist[] holds the
+        // distances).
+        int numNeighbors;
+        int *neighborNdx;
+        double *neighborDist;
+
+        // The pivots where queries start.
+        int numPivots;
+        int *pivot;
+
+        // Disallow copies.
+        CenterIndex(CenterIndex const &);
+        CenterIndex const &operator=(CenterIndex const &);
+};
+
+class CenterIndexServer {
+    public:
+        // Serve the given index (which this takes ownership of).
+        CenterIndexServer(CenterIndex *initial);
+        ~CenterIndexServer();
+
+        // Serve a new index (which this takes ownership of) from now on, and
+        // delete the previous one once no query is using it. Queries may run
+        // during a swap, but swaps must not run concurrently with each other.
+        void swap(CenterIndex *index);
+
+        // Query the index being served (see CenterIndex::nearest()).
+        int nearest(double const *xp, double *dist = NULL) const;
+        void nearest(Dataset const &x, unsigned short *labels, double *dist = NULL, int numThreads = 1) const;
+
+        // To use the index being served directly, acquire() it, which returns
+        // a slot to pass to get() and then to release() when done.
+        int acquire() const;
+        CenterIndex const *get(int slot) const { return slots[slot].index.load(); }
+        void release(int slot) const { slots[slot].readers.fetch_sub(1); }
+
+    private:
+        // Two slots, one of which holds the index being served; a swap fills
+        // the other, switches current, and waits for the readers of the old
+        // one to leave before deleting its index.
+        struct Slot {
+            std::atomic<CenterIndex *> index;
+            mutable std::atomic<int> readers;
+        };
+        Slot slots[2];
+        std::atomic<int> current;
+
+        // Disallow copies.
+        CenterIndexServer(CenterIndexServer const &);
+        CenterIndexServer const &operator=(CenterIndexServer const &);
+};
+
+#endif
@@ -0,0 +1,602 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "center_seeding.h"
+#include "general_functions.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
+
+// Sums of weights are taken over fixed blocks of this many values, and then
+// over the blocks in order, so that they do not depend on the number of
+// threads.
+static const int BLOCK_SIZE = 1024;
+
+// The splitmix64 finalizer.
+static unsigned long long mix(unsigned long long z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// A uniform random number in [0, 1) determined by the seed, a stream number
+// (e.g. the round) and an index (e.g. the point).
+static double hash_uniform(unsigned long long seed, unsigned long long stream, unsigned long long index) {
+    unsigned long long h = mix(seed + mix(stream * 0x9e3779b97f4a7c15ULL + mix(index)));
+    return (double)(h >> 11) / 9007199254740992.0; // 2^53
+}
+
+// A seed for the hash_uniform() streams, taken from rand() so that srand()
+// controls it.
+static unsigned long long draw_seed() {
+    unsigned long long seed = 0;
+    for (int i = 0; i < 4; ++i) {
+        seed = (seed << 16) ^ (unsigned long long)rand();
+    }
+    return seed;
+}
+
+// Choose an index with probability proportional to weight[i], given the
+// weight sums of each block, and r uniform in [0, total weight).
+static int pick_weighted(double const *weight, int m, double const *blockSum, int numBlocks, double r) {
+    int last = -1;
+    for (int b = 0; b < numBlocks; ++b) {
+        if (r < blockSum[b]) {
+            int end = std::min(m, (b + 1) * BLOCK_SIZE);
+            for (int i = b * BLOCK_SIZE; i < end; ++i) {
+                if (weight[i] > 0.0) {
+                    last = i;
+                    if (r < weight[i]) {
+                        return i;
+                    }
+                    r -= weight[i];
+                }
+            }
+            // rounding left r past the end of the block
+            if (last >= 0) {
+                return last;
+            }
+        }
+        r -= blockSum[b];
+    }
+    for (int i = m - 1; last < 0 && i >= 0; --i) {
+        if (weight[i] > 0.0) {
+            last = i;
+        }
+    }
+    return last;
+}
+
+struct KmeansParallelInfo {
+    Dataset const *x;
+    int k, numThreads, rounds;
+    double oversampling;
+    unsigned long long seed;
+
+    // For each point, the squared distance to the closest candidate and the
+    // index of that candidate; the sum of d2 over each block of points.
+    double *d2;
+    int *nearest;
+    double *blockSum;
+    int numBlocks;
+
+    // The candidates (point indexes), of which those from newStart on were
+    // added in the last round; and the points each thread sampled this round.
+    std::vector<int> candidates;
+    size_t newStart;
+    std::vector<int> *sampled;
+
+    // For reclustering the m candidates: each one's weight (number of
+    // closest points), squared distance to the closest chosen center, and
+    // weighted d2 (weight * d2); sums over blocks; and the chosen candidates.
+    int m;
+    double *weight, *cd2, *weighted, *cBlockSum;
+    int cNumBlocks;
+    int *chosen;
+
+    #ifdef USE_THREADS
+    pthread_barrier_t barrier;
+    #endif
+};
+
+struct KmeansParallelThread {
+    KmeansParallelInfo *info;
+    int threadId;
+    #ifdef USE_THREADS
+    pthread_t pthread_id;
+    #endif
+};
+
+static void synchronize(KmeansParallelInfo *info) {
+    #ifdef USE_THREADS
+    pthread_barrier_wait(&info->barrier);
+    #endif
+}
+
+// Set up the reclustering of the candidates (done by one thread).
+static void prepare_reclustering(KmeansParallelInfo *info) {
+    int n = info->x->n;
+    info->m = (int)info->candidates.size();
+    info->weight = new double[info->m];
+    info->cd2 = new double[info->m];
+    info->weighted = new double[info->m];
+    info->cNumBlocks = (info->m + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    info->cBlockSum = new double[info->cNumBlocks];
+    info->chosen = new int[info->k];
+
+    std::fill(info->weight, info->weight + info->m, 0.0);
+    std::fill(info->cd2, info->cd2 + info->m, std::numeric_limits<double>::max());
+    for (int i = 0; i < n; ++i) {
+        info->weight[info->nearest[i]] += 1.0;
+    }
+}
+
+// If there are no more candidates than centers, use all of them, and fill in
+// with distinct random points (done by one thread).
+static void choose_all_candidates(KmeansParallelInfo *info) {
+    int n = info->x->n;
+    std::vector<bool> used(n, false);
+    int p = 0;
+    for (; p < info->m; ++p) {
+        info->chosen[p] = info->candidates[p];
+        used[info->candidates[p]] = true;
+    }
+    for (unsigned long long q = 0; p < info->k; ++q) {
+        int i = std::min(n - 1, (int)(hash_uniform(info->seed, info->rounds + 2, q) * n));
+        if (! used[i]) {
+            used[i] = true;
+            info->chosen[p++] = i;
+        }
+    }
+}
+
+static void *kmeans_parallel_thread(void *args) {
+    KmeansParallelThread *thread = (KmeansParallelThread *)args;
+    KmeansParallelInfo *info = thread->info;
+    int t = thread->threadId, T = info->numThreads;
+    int n = info->x->n, d = info->x->d;
+    double const *data = info->x->data;
+
+    // this thread owns whole blocks of points
+    int blockStart = info->numBlocks * t / T, blockEnd = info->numBlocks * (t + 1) / T;
+    int startNdx = std::min(n, blockStart * BLOCK_SIZE), endNdx = std::min(n, blockEnd * BLOCK_SIZE);
+
+    for (int round = 0; ; ++round) {
+        // bring the distances up to date with the newest candidates
+        for (int i = startNdx; i < endNdx; ++i) {
+            for (size_t c = info->newStart; c < info->candidates.size(); ++c) {
+                double dd = distance2(data + i * d, data + info->candidates[c] * d, d);
+                if (dd < info->d2[i]) {
+                    info->d2[i] = dd;
+                    info->nearest[i] = (int)c;
+                }
+            }
+        }
+        for (int b = blockStart; b < blockEnd; ++b) {
+            int end = std::min(n, (b + 1) * BLOCK_SIZE);
+            info->blockSum[b] = 0.0;
+            for (int i = b * BLOCK_SIZE; i < end; ++i) {
+                info->blockSum[b] += info->d2[i];
+            }
+        }
+        synchronize(info);
+
+        if (round == info->rounds) {
+            break;
+        }
+
+        // sample each point independently
+        double phi = 0.0;
+        for (int b = 0; b < info->numBlocks; ++b) {
+            phi += info->blockSum[b];
+        }
+        for (int i = startNdx; i < endNdx && phi > 0.0; ++i) {
+            if (hash_uniform(info->seed, round + 1, i) * phi < info->oversampling * info->d2[i]) {
+                info->sampled[t].push_back(i);
+            }
+        }
+        synchronize(info);
+
+        if (t == 0) {
+            info->newStart = info->candidates.size();
+            for (int s = 0; s < T; ++s) {
+                info->candidates.insert(info->candidates.end(), info->sampled[s].begin(), info->sampled[s].end());
+                info->sampled[s].clear();
+            }
+        }
+        synchronize(info);
+    }
+
+    if (t == 0) {
+        prepare_reclustering(info);
+        if (info->m <= info->k) {
+            choose_all_candidates(info);
+        }
+    }
+    synchronize(info);
+
+    if (info->m <= info->k) {
+        return NULL;
+    }
+
+    // weighted k-means++ over the candidates
+    int m = info->m;
+    int cBlockStart = info->cNumBlocks * t / T, cBlockEnd = info->cNumBlocks * (t + 1) / T;
+    int cStart = std::min(m, cBlockStart * BLOCK_SIZE), cEnd = std::min(m, cBlockEnd * BLOCK_SIZE);
+    for (int p = 0; p < info->k; ++p) {
+        for (int c = cStart; c < cEnd; ++c) {
+            if (p > 0) {
+                double const *cp = data + info->candidates[c] * d;
+                double dd = distance2(cp, data + info->candidates[info->chosen[p - 1]] * d, d);
+                info->cd2[c] = std::min(info->cd2[c], dd);
+                info->weighted[c] = info->weight[c] * info->cd2[c];
+            } else {
+                info->weighted[c] = info->weight[c];
+            }
+        }
+        for (int b = cBlockStart; b < cBlockEnd; ++b) {
+            int end = std::min(m, (b + 1) * BLOCK_SIZE);
+            info->cBlockSum[b] = 0.0;
+            for (int c = b * BLOCK_SIZE; c < end; ++c) {
+                info->cBlockSum[b] += info->weighted[c];
+            }
+        }
+        synchronize(info);
+
+        if (t == 0) {
+            double total = 0.0;
+            for (int b = 0; b < info->cNumBlocks; ++b) {
+                total += info->cBlockSum[b];
+            }
+            int pick = -1;
+            if (total > 0.0) {
+                double r = hash_uniform(info->seed, info->rounds + 1, p) * total;
+                pick = pick_weighted(info->weighted, m, info->cBlockSum, info->cNumBlocks, r);
+            }
+            if (pick < 0) {
+                // every remaining candidate coincides with a chosen one; take
+                // the first that has not been chosen
+                for (pick = 0; std::find(info->chosen, info->chosen + p, pick) != info->chosen + p; ++pick) {}
+            }
+            info->chosen[p] = pick;
+        }
+        synchronize(info);
+    }
+
+    // translate candidates to point indexes
+    if (t == 0) {
+        for (int p = 0; p < info->k; ++p) {
+            info->chosen[p] = info->candidates[info->chosen[p]];
+        }
+    }
+
+    return NULL;
+}
+
+Dataset *init_centers_kmeansparallel(Dataset const &x, unsigned short k, int numThreads, int rounds, double oversampling) {
+    #ifndef USE_THREADS
+    numThreads = 1;
+    #endif
+
+    KmeansParallelInfo info;
+    info.x = &x;
+    info.k = k;
+    info.numThreads = std::max(1, numThreads);
+    info.rounds = std::max(0, rounds);
+    info.oversampling = (oversampling > 0.0) ? oversampling : 2.0 * k;
+    info.seed = draw_seed();
+    info.d2 = new double[x.n];
+    info.nearest = new int[x.n];
+    info.numBlocks = (x.n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    info.blockSum = new double[info.numBlocks];
+    info.sampled = new std::vector<int>[info.numThreads];
+    info.weight = info.cd2 = info.weighted = info.cBlockSum = NULL;
+    info.chosen = NULL;
+    info.m = info.cNumBlocks = 0;
+
+    std::fill(info.d2, info.d2 + x.n, std::numeric_limits<double>::max());
+    std::fill(info.nearest, info.nearest + x.n, 0);
+
+    // start from one point chosen uniformly at random
+    info.candidates.push_back(std::min(x.n - 1, (int)(hash_uniform(info.seed, 0, 0) * x.n)));
+    info.newStart = 0;
+
+    KmeansParallelThread *threads = new KmeansParallelThread[info.numThreads];
+    for (int t = 0; t < info.numThreads; ++t) {
+        threads[t].info = &info;
+        threads[t].threadId = t;
+    }
+    #ifdef USE_THREADS
+    pthread_barrier_init(&info.barrier, NULL, info.numThreads);
+    for (int t = 0; t < info.numThreads; ++t) {
+        pthread_create(&threads[t].pthread_id, NULL, kmeans_parallel_thread, &threads[t]);
+    }
+    for (int t = 0; t < info.numThreads; ++t) {
+        pthread_join(threads[t].pthread_id, NULL);
+    }
+    pthread_barrier_destroy(&info.barrier);
+    #else
+    kmeans_parallel_thread(&threads[0]);
+    #endif
+
+    Dataset *c = new Dataset(k, x.d);
+    for (int p = 0; p < k; ++p) {
+        memcpy(c->data + p * x.d, x.data + info.chosen[p] * x.d, sizeof(double) * x.d);
+    }
+
+    delete [] threads;
+    delete [] info.d2;
+    delete [] info.nearest;
+    delete [] info.blockSum;
+    delete [] info.sampled;
+    delete [] info.weight;
+    delete [] info.cd2;
+    delete [] info.weighted;
+    delete [] info.cBlockSum;
+    delete [] info.chosen;
+
+    return c;
+}
+
+// A complete binary tree over n leaf weights, where each internal node holds
+// the sum of its children, for drawing weighted samples in O(log n) time.
+// Internal sums are always recomputed from the children (never adjusted by
+// differences), so they depend only on the leaves, not on the update order.
+class SumTree {
+    public:
+        SumTree(int n) : size(1) {
+            while (size < n) {
+                size *= 2;
+            }
+            node = new double[2 * size];
+            std::fill(node, node + 2 * size, 0.0);
+        }
+        ~SumTree() { delete [] node; }
+
+        // Set a leaf without updating its ancestors; call rebuild() after.
+        void setLeaf(int i, double w) { node[size + i] = w; }
+        void rebuild() {
+            for (int v = size - 1; v >= 1; --v) {
+                node[v] = node[2 * v] + node[2 * v + 1];
+            }
+        }
+
+        // Set a leaf and update its ancestors.
+        void update(int i, double w) {
+            int v = size + i;
+            node[v] = w;
+            for (v /= 2; v >= 1; v /= 2) {
+                node[v] = node[2 * v] + node[2 * v + 1];
+            }
+        }
+
+        double total() const { return node[1]; }
+
+        // Choose a leaf with probability proportional to its weight, given r
+        // uniform in [0, total()). Never returns a zero-weight leaf unless
+        // the total is zero.
+        int sample(double r) const {
+            int v = 1;
+            while (v < size) {
+                int left = 2 * v;
+                if ((r < node[left] && node[left] > 0.0) || node[left + 1] <= 0.0) {
+                    v = left;
+                } else {
+                    r -= node[left];
+                    v = left + 1;
+                }
+            }
+            return v - size;
+        }
+
+    private:
+        int size;
+        double *node;
+
+        SumTree(SumTree const &);
+        SumTree const &operator=(SumTree const &);
+};
+
+struct KmeansPlusPlusInfo {
+    Dataset const *x;
+    int k, numThreads;
+    unsigned long long seed;
+
+    // For each point, the squared distance to the closest chosen center and
+    // the index of that center.
+    double *d2;
+    int *nearest;
+    SumTree *tree;
+
+    // The chosen centers (point indexes); for each one, the points closest to
+    // it, and the largest d2 among them; and the points each thread found to
+    // be closest to the newest center.
+    int *chosen;
+    std::vector<int> *members;
+    double *maxD2;
+    std::vector<int> *moved;
+
+    #ifdef USE_THREADS
+    pthread_barrier_t barrier;
+    #endif
+};
+
+struct KmeansPlusPlusThread {
+    KmeansPlusPlusInfo *info;
+    int threadId;
+    #ifdef USE_THREADS
+    pthread_t pthread_id;
+    #endif
+};
+
+static void synchronize(KmeansPlusPlusInfo *info) {
+    #ifdef USE_THREADS
+    pthread_barrier_wait(&info->barrier);
+    #endif
+}
+
+// Choose the next center from the sum-tree (done by one thread).
+static void choose_next_center(KmeansPlusPlusInfo *info, int p, std::vector<bool> &used) {
+    int n = info->x->n;
+    int pick = -1;
+    if (info->tree->total() > 0.0) {
+        pick = info->tree->sample(hash_uniform(info->seed, 1, p) * info->tree->total());
+    }
+    if (pick < 0 || used[pick]) {
+        // every remaining point coincides with a chosen center; take the
+        // first that has not been chosen
+        for (pick = 0; pick < n && used[pick]; ++pick) {}
+    }
+    used[pick] = true;
+    info->chosen[p] = pick;
+}
+
+static void *kmeans_plusplus_thread(void *args) {
+    KmeansPlusPlusThread *thread = (KmeansPlusPlusThread *)args;
+    KmeansPlusPlusInfo *info = thread->info;
+    int t = thread->threadId, T = info->numThreads;
+    int n = info->x->n, d = info->x->d;
+    double const *data = info->x->data;
+    std::vector<bool> used;
+
+    // distances to the first center, chosen uniformly at random
+    int startNdx = (int)((long long)n * t / T), endNdx = (int)((long long)n * (t + 1) / T);
+    double const *first = data + info->chosen[0] * d;
+    for (int i = startNdx; i < endNdx; ++i) {
+        info->d2[i] = distance2(data + i * d, first, d);
+        info->nearest[i] = 0;
+        info->tree->setLeaf(i, info->d2[i]);
+    }
+    synchronize(info);
+
+    if (t == 0) {
+        used.assign(n, false);
+        used[info->chosen[0]] = true;
+        info->tree->rebuild();
+        info->members[0].resize(n);
+        info->maxD2[0] = 0.0;
+        for (int i = 0; i < n; ++i) {
+            info->members[0][i] = i;
+            info->maxD2[0] = std::max(info->maxD2[0], info->d2[i]);
+        }
+        if (info->k > 1) {
+            choose_next_center(info, 1, used);
+        }
+    }
+    synchronize(info);
+
+    for (int p = 1; p < info->k; ++p) {
+        double const *z = data + info->chosen[p] * d;
+
+        // Each thread takes every T-th center. A point x closest to center c
+        // can only be closer to z if d(c, z) < 2 D(x).
+        for (int c = t; c < p; c += T) {
+            double cz2 = distance2(data + info->chosen[c] * d, z, d);
+            if (cz2 >= 4.0 * info->maxD2[c]) {
+                continue;
+            }
+            std::vector<int> &m = info->members[c];
+            double maxD2 = 0.0;
+            size_t kept = 0;
+            for (size_t q = 0; q < m.size(); ++q) {
+                int i = m[q];
+                if (cz2 < 4.0 * info->d2[i]) {
+                    double dd = distance2(data + i * d, z, d);
+                    if (dd < info->d2[i]) {
+                        info->d2[i] = dd;
+                        info->nearest[i] = p;
+                        info->moved[t].push_back(i);
+                        continue;
+                    }
+                }
+                maxD2 = std::max(maxD2, info->d2[i]);
+                m[kept++] = i;
+            }
+            m.resize(kept);
+            info->maxD2[c] = maxD2;
+        }
+        synchronize(info);
+
+        if (t == 0) {
+            info->maxD2[p] = 0.0;
+            for (int s = 0; s < T; ++s) {
+                for (size_t q = 0; q < info->moved[s].size(); ++q) {
+                    int i = info->moved[s][q];
+                    info->members[p].push_back(i);
+                    info->maxD2[p] = std::max(info->maxD2[p], info->d2[i]);
+                    info->tree->update(i, info->d2[i]);
+                }
+                info->moved[s].clear();
+            }
+            if (p + 1 < info->k) {
+                choose_next_center(info, p + 1, used);
+            }
+        }
+        synchronize(info);
+    }
+
+    return NULL;
+}
+
+Dataset *init_centers_kmeanspp_fast(Dataset const &x, unsigned short k, int numThreads) {
+    #ifndef USE_THREADS
+    numThreads = 1;
+    #endif
+
+    KmeansPlusPlusInfo info;
+    info.x = &x;
+    info.k = k;
+    info.numThreads = std::max(1, numThreads);
+    info.seed = draw_seed();
+    info.d2 = new double[x.n];
+    info.nearest = new int[x.n];
+    info.tree = new SumTree(x.n);
+    info.chosen = new int[k];
+    info.members = new std::vector<int>[k];
+    info.maxD2 = new double[k];
+    info.moved = new std::vector<int>[info.numThreads];
+
+    info.chosen[0] = std::min(x.n - 1, (int)(hash_uniform(info.seed, 0, 0) * x.n));
+
+    KmeansPlusPlusThread *threads = new KmeansPlusPlusThread[info.numThreads];
+    for (int t = 0; t < info.numThreads; ++t) {
+        threads[t].info = &info;
+        threads[t].threadId = t;
+    }
+    #ifdef USE_THREADS
+    pthread_barrier_init(&info.barrier, NULL, info.numThreads);
+    for (int t = 0; t < info.numThreads; ++t) {
+        pthread_create(&threads[t].pthread_id, NULL, kmeans_plusplus_thread, &threads[t]);
+    }
+    for (int t = 0; t < info.numThreads; ++t) {
+        pthread_join(threads[t].pthread_id, NULL);
+    }
+    pthread_barrier_destroy(&info.barrier);
+    #else
+    kmeans_plusplus_thread(&threads[0]);
+    #endif
+
+    Dataset *c = new Dataset(k, x.d);
+    for (int p = 0; p < k; ++p) {
+        memcpy(c->data + p * x.d, x.data + info.chosen[p] * x.d, sizeof(double) * x.d);
+    }
+
+    delete [] threads;
+    delete [] info.d2;
+    delete [] info.nearest;
+    delete info.tree;
+    delete [] info.chosen;
+    delete [] info.members;
+    delete [] info.maxD2;
+    delete [] info.moved;
+
+    return c;
+}
@@ -0,0 +1,53 @@
+#ifndef CENTER_SEEDING_H
+#define CENTER_SEEDING_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * Seeding methods for large datasets and large k, which (unlike those in
+ * general_functions.h) are multithreaded. Their random choices are drawn from
+ * a hash of a seed taken from rand() and the point index, so for a given
+ * srand() seed they choose the same centers for any number of threads.
+ */
+
+#include "dataset.h"
+
+/* Initialize the centers with k-means|| (Bahmani et al., "Scalable K-Means++").
+ * Starting from one random point, each round samples every point
+ * independently with probability oversampling * D(x)^2 / sum D^2, where D(x)
+ * is the distance to the closest candidate so far. The candidates are then
+ * weighted by how many points they are closest to, and k of them are chosen
+ * by weighted k-means++.
+ *
+ * Parameters:
+ *  x -- records that are being clustered (n * d)
+ *  k -- the number of centers to choose (at most n)
+ *  numThreads -- the number of threads to use
+ *  rounds -- the number of sampling rounds
+ *  oversampling -- the expected number of candidates per round; if not
+ *      positive, 2 * k is used
+ * Return value: the chosen centers (k * d), which the caller must delete
+ */
+Dataset *init_centers_kmeansparallel(Dataset const &x, unsigned short k,
+        int numThreads = 1, int rounds = 5, double oversampling = 0.0);
+
+/* Initialize the centers with exact k-means++ (each center is chosen with
+ * probability proportional to D(x)^2, the squared distance to the closest
+ * center chosen so far), made fast for large k:
+ *  - each center keeps a list of the points closest to it; when a new center
+ *    z is added, a point x closest to c is skipped if d(c, z) >= 2 D(x), and
+ *    the whole list is skipped if that holds for its furthest point;
+ *  - samples are drawn from a sum-tree over D(x)^2 in O(log n) time.
+ * The lists are divided among the threads.
+ *
+ * Parameters:
+ *  x -- records that are being clustered (n * d)
+ *  k -- the number of centers to choose (at most n)
+ *  numThreads -- the number of threads to use
+ * Return value: the chosen centers (k * d), which the caller must delete
+ */
+Dataset *init_centers_kmeanspp_fast(Dataset const &x, unsigned short k, int numThreads = 1);
+
+#endif
@@ -0,0 +1,152 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "chunked_dataset.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char const BINARY_MAGIC[8] = { 'F', 'K', 'M', 'D', 'A', 'T', 'A', '1' };
+static const size_t BINARY_HEADER_SIZE = 16;
+
+ChunkedDataset::ChunkedDataset() : n(0), d(0), chunkSize(0), position(0),
+    textStart(0), fd(-1), mapped(NULL), mappedLength(0) {}
+
+bool ChunkedDataset::open(std::string const &filename, int aChunkSize, bool useMmap) {
+    close();
+    chunkSize = std::max(1, aChunkSize);
+
+    // binary files are recognized by their header
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    char header[BINARY_HEADER_SIZE];
+    if (pread(fd, header, BINARY_HEADER_SIZE, 0) == (ssize_t)BINARY_HEADER_SIZE &&
+            memcmp(header, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0) {
+        int32_t dims[2];
+        memcpy(dims, header + sizeof(BINARY_MAGIC), sizeof(dims));
+        n = dims[0];
+        d = dims[1];
+        if (n < 0 || d < 1) {
+            close();
+            return false;
+        }
+
+        // check that the records fit in the file (mapping past its end would
+        // fault when read)
+        struct stat info;
+        size_t length = BINARY_HEADER_SIZE + (size_t)n * d * sizeof(double);
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < length) {
+            close();
+            return false;
+        }
+        if (useMmap) {
+            mappedLength = length;
+            void *m = mmap(NULL, mappedLength, PROT_READ, MAP_SHARED, fd, 0);
+            if (m == MAP_FAILED) {
+                close();
+                return false;
+            }
+            madvise(m, mappedLength, MADV_SEQUENTIAL);
+            mapped = (double const *)((char const *)m + BINARY_HEADER_SIZE);
+        }
+        return true;
+    }
+    ::close(fd);
+    fd = -1;
+
+    text.open(filename.c_str());
+    if (! (text >> n >> d) || n < 0 || d < 1) {
+        close();
+        return false;
+    }
+    textStart = text.tellg();
+    return true;
+}
+
+void ChunkedDataset::close() {
+    if (mapped) {
+        munmap((void *)((char const *)mapped - BINARY_HEADER_SIZE), mappedLength);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    if (text.is_open()) {
+        text.close();
+    }
+    text.clear();
+    mapped = NULL;
+    mappedLength = 0;
+    fd = -1;
+    n = d = position = 0;
+}
+
+void ChunkedDataset::rewind() {
+    position = 0;
+    if (text.is_open()) {
+        text.clear();
+        text.seekg(textStart);
+    }
+}
+
+int ChunkedDataset::next(double *buffer, double const **records) {
+    int count = std::min(chunkSize, n - position);
+    if (count <= 0) {
+        return 0;
+    }
+
+    if (mapped) {
+        *records = mapped + (size_t)position * d;
+        // ask the OS to start reading the following chunk
+        size_t nextStart = (size_t)(position + count) * d * sizeof(double);
+        size_t nextLength = (size_t)std::min(chunkSize, n - position - count) * d * sizeof(double);
+        if (nextLength > 0) {
+            long pageSize = sysconf(_SC_PAGESIZE);
+            size_t offset = BINARY_HEADER_SIZE + nextStart;
+            size_t aligned = offset - offset % pageSize;
+            madvise((char *)mapped - BINARY_HEADER_SIZE + aligned, nextLength + (offset - aligned), MADV_WILLNEED);
+        }
+    } else if (fd >= 0) {
+        size_t length = (size_t)count * d * sizeof(double);
+        off_t offset = BINARY_HEADER_SIZE + (off_t)position * d * sizeof(double);
+        size_t done = 0;
+        while (done < length) {
+            ssize_t got = pread(fd, (char *)buffer + done, length - done, offset + done);
+            if (got <= 0) {
+                return -1;
+            }
+            done += got;
+        }
+        *records = buffer;
+    } else {
+        for (int v = 0; v < count * d; ++v) {
+            text >> buffer[v];
+        }
+        if (! text) {
+            return -1;
+        }
+        *records = buffer;
+    }
+
+    position += count;
+    return count;
+}
+
+bool ChunkedDataset::writeBinary(Dataset const &x, std::string const &filename) {
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    char header[BINARY_HEADER_SIZE];
+    int32_t dims[2] = { x.n, x.d };
+    memcpy(header, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    memcpy(header + sizeof(BINARY_MAGIC), dims, sizeof(dims));
+    out.write(header, BINARY_HEADER_SIZE);
+    out.write((char const *)x.data, (std::streamsize)x.nd * sizeof(double));
+    return (bool)out;
+}
@@ -0,0 +1,72 @@
+#ifndef CHUNKED_DATASET_H
+#define CHUNKED_DATASET_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * A ChunkedDataset reads a dataset file sequentially, a fixed number of
+ * records (a chunk) at a time, so that datasets larger than memory can be
+ * clustered. Two file formats are understood:
+ *  - the text format used by the drivers ("n d" followed by the n * d
+ *    values), and
+ *  - a binary format: the 8 bytes "FKMDATA1", n and d as 32-bit integers, and
+ *    then the n * d values as native doubles in record-major order. Binary
+ *    files are read with pread(), or can be memory-mapped, in which case
+ *    chunks are returned in place without copying.
+ */
+
+#include "dataset.h"
+#include <fstream>
+#include <string>
+
+class ChunkedDataset {
+    public:
+        ChunkedDataset();
+        ~ChunkedDataset() { close(); }
+
+        // Open the file, reading chunks of (up to) aChunkSize records. Binary
+        // files are memory-mapped if useMmap is true. Returns false if the
+        // file cannot be opened, its header is invalid, or (for binary files)
+        // it is shorter than its header says.
+        bool open(std::string const &filename, int aChunkSize, bool useMmap = false);
+        void close();
+
+        // Go back to the first chunk.
+        void rewind();
+
+        // Read the next chunk. The records are copied into buffer (which must
+        // hold chunkSize * d values), and *records is set to point to them
+        // (or directly into the mapped file, when memory-mapped). Returns the
+        // number of records in the chunk, which is 0 at the end of the file,
+        // or -1 if the records cannot be read (the file is shorter than its
+        // header says, or a text file has an invalid value).
+        int next(double *buffer, double const **records);
+
+        // Write x to filename in the binary format. Returns false on failure.
+        static bool writeBinary(Dataset const &x, std::string const &filename);
+
+        // The number of records and dimension of the dataset, and the chunk
+        // size.
+        int n, d, chunkSize;
+
+    private:
+        // The index of the next record to be read.
+        int position;
+
+        // For text files, the stream and the offset of the first value.
+        std::ifstream text;
+        std::streampos textStart;
+
+        // For binary files, the file descriptor, and the mapping (if any).
+        int fd;
+        double const *mapped;
+        size_t mappedLength;
+
+        // Disallow copies.
+        ChunkedDataset(ChunkedDataset const &);
+        ChunkedDataset const &operator=(ChunkedDataset const &);
+};
+
+#endif
@@ -17,6 +17,7 @@ class CompareKmeans : public OriginalSpaceKmeans {
         CompareKmeans() : centersDist2div4(NULL) {}
         virtual ~CompareKmeans() { free(); }
         virtual void free();
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
         virtual std::string getName() const { return "compare"; }
     
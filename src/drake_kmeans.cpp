@@ -9,11 +9,22 @@
 #include <cmath>
 #include <algorithm>
 #include <cassert>
+#include <limits>
 
-DrakeKmeans::DrakeKmeans(int aB) : closestOtherCenters(NULL) {
+DrakeKmeans::DrakeKmeans(int aB) : closestOtherCenters(NULL), numBounds(aB) {
     numLowerBounds = aB;
 }
 
+int DrakeKmeans::getNumBounds(int aK) const {
+    if (numBounds != ADAPTIVE) {
+        return numBounds;
+    }
+
+    // start at k/4, fixing any degenerate cases
+    int b = std::max(2, aK / 4);
+    return (aK <= b) ? aK - 1 : b;
+}
+
 void DrakeKmeans::free() {
     for (int i = 0; i < n; ++i) {
         delete [] closestOtherCenters[i];
@@ -88,6 +99,7 @@ int DrakeKmeans::runThread(int threadId, int maxIterations) {
             
             // If nothing happened when we tried to move centers, we've converged!
             converged = (0.0 == centerMovement[furthestMovingCenter]);
+            update_center_index();
         }
 
         // Otherwise, release tension in the bounds caused by centers' movement
@@ -106,6 +118,8 @@ int DrakeKmeans::runThread(int threadId, int maxIterations) {
 }
 
 void DrakeKmeans::initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads) {
+    // the base class allocates the bounds
+    numLowerBounds = getNumBounds(aK);
     TriangleInequalityBaseKmeans::initialize(aX, aK, initialAssignment, aNumThreads);
 
     assert(0 < numLowerBounds);
@@ -120,6 +134,17 @@ void DrakeKmeans::initialize(Dataset const *aX, unsigned short aK, unsigned shor
     }
 }
 
+void DrakeKmeans::seed_bounds(std::pair<double, int> const *nearest, int m, int startNdx, int endNdx) {
+    for (int i = startNdx; i < endNdx; ++i) {
+        upper[i] = sqrt(nearest[i * m].first);
+        for (int j = 0; j < numLowerBounds; ++j) {
+            closestOtherCenters[i][j] = nearest[i * m + j + 1].second;
+            lower[i * numLowerBounds + j] = sqrt(nearest[i * m + j + 1].first);
+        }
+    }
+    update_bounds(startNdx, endNdx, numLowerBounds);
+}
+
 void DrakeKmeans::update_bounds(int startNdx, int endNdx, int numLowerBoundsRemaining) {
     int furthestMovingCenter = (int)(std::max_element(centerMovement, centerMovement + k) - centerMovement);
 
@@ -151,13 +176,18 @@ void DrakeKmeans::update_bounds(int startNdx, int endNdx, int numLowerBoundsRema
 
 
 void DrakeKmeans::find_near_centers(int i, int numLowerBoundsRemaining, std::pair<double, int> *order, int threadId) {
-    // Sort all centers by increasing distance from this point
-    for (int j = 0; j < k; ++j) {
-        // Record the squared distances
-        order[j].first = pointCenterDist2(i, j);
-        order[j].second = j;
+    if (centerIndex) {
+        // Only the nearest centers are needed, in order
+        find_nearest_centers(i, numLowerBoundsRemaining + 1, std::numeric_limits<double>::max(), order, threadId);
+    } else {
+        // Sort all centers by increasing distance from this point
+        for (int j = 0; j < k; ++j) {
+            // Record the squared distances
+            order[j].first = pointCenterDist2(i, j);
+            order[j].second = j;
+        }
+        std::partial_sort(order, order + numLowerBoundsRemaining + 1, order + k);
     }
-    std::partial_sort(order, order + numLowerBoundsRemaining + 1, order + k);
 
     // Reassign the center (incremental)
     if (assignment[i] != order[0].second) {
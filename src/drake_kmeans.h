@@ -16,11 +16,21 @@
 
 class DrakeKmeans : public TriangleInequalityBaseKmeans {
     public:
+        // Use aNumBounds lower bounds per point, which must be in [1, k). If
+        // it is ADAPTIVE, initialize() chooses k / 4 bounds (but at least 2
+        // and fewer than k).
         DrakeKmeans(int aNumBounds);
         virtual ~DrakeKmeans() { free(); }
+
+        static int const ADAPTIVE = 0;
+
+        // The number of bounds the algorithm uses with aK centers.
+        int getNumBounds(int aK) const;
+
         virtual void free();
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
-        virtual std::string getName() const { return "drake"; }
+        virtual std::string getName() const { return useCenterIndex ? "drake+index" : "drake"; }
     
     protected:
         virtual int runThread(int threadId, int maxIterations);
@@ -28,6 +38,9 @@ class DrakeKmeans : public TriangleInequalityBaseKmeans {
         // For each point, the indexes of the closest centers other than the
         // assigned center. Size is n * numLowerBounds.
         unsigned short **closestOtherCenters;
+
+        // The number of bounds given to the constructor.
+        int numBounds;
     
         // Find the centers that are nearest point i. The parameter "order" is
         // an array of pairs that will contain the closest
@@ -45,6 +58,10 @@ class DrakeKmeans : public TriangleInequalityBaseKmeans {
         // Update the upper and lower bounds for the given points.  Assumes that
         // centerMovement has been computed.
         void update_bounds(int startNdx, int endNdx, int numLowerBoundsRemaining);
+
+        // The bounds need the numLowerBounds + 1 nearest initial centers.
+        virtual int numSeedCenters(int aK) const { return getNumBounds(aK) + 1; }
+        virtual void seed_bounds(std::pair<double, int> const *nearest, int m, int startNdx, int endNdx);
 };
 
 #endif
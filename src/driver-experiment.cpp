@@ -10,7 +10,7 @@
  * standard input. Input lines should take one of the following forms:
  *
  * dataset some_dataset.txt
- * initialize k [random|kpp]
+ * initialize k [random|kpp|kppfast|kmeansparallel|afkmc2 M]
  * lloyd
  * hamerly
  * elkan
@@ -18,6 +18,20 @@
  * annulus
  * compare
  * sort
+ * kdtree
+ * minibatch B P
+ * stream FILE CHUNKSIZE K [double|float] [read|mmap]
+ * dump_binary FILE
+ * centerindex [on|off]
+ * kernelcache MB
+ * kernelincremental [on|off]
+ * kernel nystrom M ALGORITHM [gaussian T | linear | polynomial A P]
+ * kernel fourier D SEED ALGORITHM gaussian T
+ * restarts R [random|kpp] MARGIN
+ * ksweep KMIN KMAX STEP
+ * serve L
+ * save_model FILE
+ * load_model FILE
  *
  * There are a number of shorthand alternatives,
  * e.g. init for initialize, data for dataset
@@ -46,19 +60,38 @@
 #include "compare_kmeans.h"
 #include "sort_kmeans.h"
 #include "heap_kmeans.h"
+#include "kdtree_kmeans.h"
+#include "center_seeding.h"
+#include "minibatch_kmeans.h"
+#include "streaming_kmeans.h"
+#include "multirestart_kmeans.h"
+#include "k_sweep.h"
+#include "center_index.h"
+#include "kmeans_model.h"
 #include "naive_kernel_kmeans.h"
 #include "elkan_kernel_kmeans.h"
+#include "hamerly_kernel_kmeans.h"
+#include "kernel_features.h"
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <cassert>
+#include <cmath>
 #include <string>
+#include <sstream>
 #include <map>
 #include <ctime>
 #include <unistd.h>
 #include <cstdlib>
 
-void execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned short k, unsigned short const *assignment,
+#ifdef MONITOR_ACCURACY
+// How much the SSE of an algorithm whose centers match the reference
+// algorithm's only to rounding may differ (relative to the reference SSE).
+static const double SSE_TOLERANCE = 1e-9;
+#endif
+
+// Returns the number of iterations run, or -1 if the algorithm could not run.
+int execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned short k, Dataset const *initialCenters,
         unsigned short *outAssignment, Dataset *outCenters,
         int xcNdx, int numThreads, int maxIterations,
         std::vector<int> *numItersHistory
@@ -67,10 +100,51 @@ void execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned
         #endif
         );
 
+void executeStreaming(StreamingKmeans *algorithm, ChunkedDataset *source, Dataset const &initialCenters,
+        int xcNdx, int numThreads, int maxIterations,
+        std::vector<int> *numItersHistory
+        #ifdef MONITOR_ACCURACY
+        , std::vector<double> *sseHistory
+        #endif
+        );
+
+// Set whether the given algorithm uses a NearCenterIndex, and return it.
+static Kmeans *withCenterIndex(TriangleInequalityBaseKmeans *algorithm, bool useCenterIndex) {
+    algorithm->setUseCenterIndex(useCenterIndex);
+    return algorithm;
+}
+
+// Create the original-space algorithm with the given name (for clustering
+// kernel features), or return NULL if there is none.
+static Kmeans *originalSpaceAlgorithm(std::string const &name, unsigned short k, bool useCenterIndex) {
+    if (name == "lloyd" || name == "naive") {
+        return new NaiveKmeans();
+    } else if (name == "hamerly") {
+        return withCenterIndex(new HamerlyKmeans(), useCenterIndex);
+    } else if (name == "annulus" || name == "norm") {
+        return withCenterIndex(new AnnulusKmeans(), useCenterIndex);
+    } else if (name == "elkan") {
+        return new ElkanKmeans();
+    } else if (name == "adaptive") {
+        int b = std::max(2, k / 4);
+        if (k <= b) {
+            return withCenterIndex(new HamerlyKmeans(), useCenterIndex);
+        }
+        return withCenterIndex(new DrakeKmeans(b), useCenterIndex);
+    } else if (name == "compare") {
+        return new CompareKmeans();
+    } else if (name == "sort") {
+        return new SortKmeans();
+    } else if (name == "heap") {
+        return new HeapKmeans();
+    }
+    return NULL;
+}
+
 int main(int argc, char **argv) {
     // The set of data points; the set of centers
     Dataset *x = NULL;
-    unsigned short *assignment = NULL;
+    Dataset *initialCenters = NULL;
     unsigned short k;
     unsigned short *outAssignment = NULL;
     Dataset *outCenters = NULL;
@@ -78,6 +152,26 @@ int main(int argc, char **argv) {
     // The algorithm being used
     Kmeans *algorithm = NULL;
 
+    // A kd-tree over the dataset, built the first time it is needed and kept
+    // for later runs on the same dataset
+    KdTree *kdTree = NULL;
+
+    // Whether the hamerly, annulus, drake and adaptive algorithms search an
+    // index over the centers instead of scanning all of them
+    bool useCenterIndex = false;
+
+    // The memory (in megabytes) the kernel algorithms may use to cache kernel
+    // values; 0 disables the cache
+    double kernelCacheMB = 0.0;
+
+    // Whether the kernel algorithms maintain their cluster statistics
+    // incrementally
+    bool kernelIncremental = true;
+
+    // The threshold below which the kernel algorithms treat gaussian kernel
+    // values as zero; 0 uses the exact kernel
+    double kernelCutoff = 0.0;
+
     #ifdef MONITOR_ACCURACY
     std::vector<double> sseHistory;
     #endif
@@ -87,6 +181,12 @@ int main(int argc, char **argv) {
     int numThreads = 1;
     int maxIterations = std::numeric_limits<int>::max();
 
+    // How the current centers were produced, for save_model: the
+    // initialization method, and the last algorithm run from it (if any)
+    std::string initMethod;
+    std::string modelAlgorithm;
+    int modelIterations = 0;
+
     // Print header row
     std::cout << std::setw(35) << "algorithm" << "\t"
               << std::setw(5) << "iters" << "\t"
@@ -136,11 +236,13 @@ int main(int argc, char **argv) {
             input >> n >> d;
 
             // Allocate storage
+            delete kdTree;
+            kdTree = NULL;
             delete x;
-            delete [] assignment;
+            delete initialCenters;
             delete [] outAssignment;
             delete outCenters;
-            assignment = NULL;
+            initialCenters = NULL;
             outAssignment = NULL;
             outCenters = NULL;
             x = new Dataset(n, d);
@@ -172,6 +274,20 @@ int main(int argc, char **argv) {
                 // Perform random initialization
                 std::cout << "initializing with random:  k = " << k << std::endl;
                 c = init_centers(*x, k);
+            } else if (method == "kmeansparallel" || method == "kmeans||") {
+                // Perform k-means|| initialization
+                std::cout << "initializing with kmeans||: k = " << k << std::endl;
+                c = init_centers_kmeansparallel(*x, k, numThreads);
+            } else if (method == "kppfast") {
+                // Perform exact k-means++ with pruning and a sum-tree
+                std::cout << "initializing with kmeans++ (fast): k = " << k << std::endl;
+                c = init_centers_kmeanspp_fast(*x, k, numThreads);
+            } else if (method == "afkmc2") {
+                // Perform AFK-MC^2 initialization with chains of length M
+                int chainLength;
+                std::cin >> chainLength;
+                std::cout << "initializing with afkmc2: k = " << k << ", chain length = " << chainLength << std::endl;
+                c = init_centers_afkmc2(*x, k, chainLength);
             }
 
             delete outCenters;
@@ -183,13 +299,15 @@ int main(int argc, char **argv) {
                 continue;
             }
 
-            delete [] assignment;
-            assignment = new unsigned short[x->n];
+            // the algorithms assign the points to these centers themselves
+            delete initialCenters;
+            delete [] outAssignment;
+            initialCenters = c;
             outAssignment = new unsigned short[x->n];
-            std::fill(assignment, assignment + x->n, 0);
-            assign(*x, *c, assignment);
-            std::copy(assignment, assignment + x->n, outAssignment);
-            delete c;
+            std::fill(outAssignment, outAssignment + x->n, 0);
+            initMethod = method;
+            modelAlgorithm.clear();
+            modelIterations = 0;
         } else if (command == "seed") {
             // Read the random seed
             int seed;
@@ -198,9 +316,9 @@ int main(int argc, char **argv) {
         } else if (command == "lloyd" || command == "naive") {
             algorithm = new NaiveKmeans();
         } else if (command == "hamerly") {
-            algorithm = new HamerlyKmeans();
+            algorithm = withCenterIndex(new HamerlyKmeans(), useCenterIndex);
         } else if (command == "annulus" || command == "norm") {
-            algorithm = new AnnulusKmeans();
+            algorithm = withCenterIndex(new AnnulusKmeans(), useCenterIndex);
         } else if (command == "elkan") {
             algorithm = new ElkanKmeans();
         } else if (command == "drake") {
@@ -214,25 +332,354 @@ int main(int argc, char **argv) {
                 continue;
             }
 
-            algorithm = new DrakeKmeans(b);
+            algorithm = withCenterIndex(new DrakeKmeans(b), useCenterIndex);
         } else if (command == "adaptive") {
-            // Start at k/4
-            int b = k / 4;
-
-            // Fix any degenerate cases
-            if (b < 2) b = 2;
-            if (k <= b) b = k - 1;
-
-            algorithm = new DrakeKmeans(b);
+            // Drake's algorithm with k/4 bounds
+            algorithm = withCenterIndex(new DrakeKmeans(DrakeKmeans::ADAPTIVE), useCenterIndex);
         } else if (command == "compare") {
             algorithm = new CompareKmeans();
         } else if (command == "sort") {
             algorithm = new SortKmeans();
         } else if (command == "heap") {
             algorithm = new HeapKmeans();
-        } else if (command == "kernel" || command == "elkan_kernel") {
+        } else if (command == "kdtree") {
+            if (x != NULL && kdTree == NULL) {
+                kdTree = new KdTree(x, numThreads);
+            }
+            algorithm = new KdTreeKmeans(kdTree);
+        } else if (command == "minibatch") {
+            // Read the batch size and patience
+            int batchSize, patience;
+            std::cin >> batchSize >> patience;
+
+            if (batchSize < 1 || patience < 0) {
+                std::cerr << "Invalid minibatch parameters: " << batchSize << " " << patience << std::endl;
+                continue;
+            }
+
+            algorithm = new MiniBatchKmeans(batchSize, patience);
+        } else if (command == "stream") {
+            std::string fileName, bounds, io;
+            int chunkSize, streamK;
+            std::cin >> fileName >> chunkSize >> streamK >> bounds >> io;
+
+            if (chunkSize < 1 || streamK < 1 || (bounds != "double" && bounds != "float") || (io != "read" && io != "mmap")) {
+                std::cerr << "Invalid stream parameters" << std::endl;
+                continue;
+            }
+
+            ChunkedDataset source;
+            if (! source.open(fileName, chunkSize, io == "mmap")) {
+                std::cerr << "Unable to open data file: " << fileName << std::endl;
+                continue;
+            }
+            if (source.n < streamK) {
+                std::cerr << "Not enough records for k = " << streamK << std::endl;
+                continue;
+            }
+
+            // Start from the current initialization if it is for a dataset of
+            // the same shape (for comparison with the other algorithms), and
+            // from a random sample of the records otherwise
+            Dataset *streamCenters = NULL;
+            if (x != NULL && initialCenters != NULL && x->n == source.n && x->d == source.d && k == streamK) {
+                NaiveKmeans means;
+                unsigned short *meansAssignment = new unsigned short[x->n];
+                means.initialize(x, *initialCenters, meansAssignment, numThreads);
+                streamCenters = new Dataset(*means.getCenters());
+                delete [] meansAssignment;
+            } else {
+                streamCenters = StreamingKmeans::sample_centers(&source, streamK);
+                if (streamCenters == NULL) {
+                    std::cerr << "Unable to read data file: " << fileName << std::endl;
+                    continue;
+                }
+            }
+
+            StreamingKmeans streaming(bounds == "float");
+            executeStreaming(&streaming, &source, *streamCenters,
+                    xcNdx, numThreads, maxIterations, &numItersHistory
+                    #ifdef MONITOR_ACCURACY
+                    , &sseHistory
+                    #endif
+                    );
+            delete streamCenters;
+        } else if (command == "dump_binary") {
+            std::string fileName;
+            std::cin >> fileName;
+            if (x == NULL || ! ChunkedDataset::writeBinary(*x, fileName)) {
+                std::cerr << "Error: unable to write the dataset to " << fileName << std::endl;
+            }
+        } else if (command == "restarts") {
+            int runs;
+            std::string method;
+            double margin;
+            std::cin >> runs >> method >> margin;
+
+            if (x == NULL || initialCenters == NULL) {
+                std::cerr << "Please initialize first (to choose k)" << std::endl;
+                continue;
+            }
+            if (runs < 1 || (method != "random" && method != "kpp")) {
+                std::cerr << "Invalid restarts parameters" << std::endl;
+                continue;
+            }
+
+            Dataset **initialCenters = new Dataset *[runs];
+            for (int r = 0; r < runs; ++r) {
+                initialCenters[r] = (method == "random") ? init_centers(*x, k) : init_centers_kmeanspp_v2(*x, k);
+            }
+
+            MultiRestartKmeans restarts(margin);
+            std::cout << std::setw(35) << restarts.getName() << "\t" << std::flush;
+
+            rusage start_clustering_time = get_time();
+            double start_clustering_wall_time = get_wall_time();
+            restarts.initialize(x, initialCenters, runs, numThreads);
+            int passes = restarts.run(maxIterations);
+            double cluster_time = elapsed_time(&start_clustering_time);
+            double cluster_wall_time = get_wall_time() - start_clustering_wall_time;
+
+            // restarts are not compared with the iteration and SSE history,
+            // since they start from different centers
+            std::cout << std::setw(5) << passes << "\t";
+            std::cout << std::setw(10) << numThreads << "\t";
+            std::cout << std::setw(10) << cluster_time << "\t";
+            std::cout << std::setw(10) << cluster_wall_time << "\t";
+            std::cout << std::setw(8) << (getMemoryUsage() / 1024.0);
+            #ifdef MONITOR_ACCURACY
+            std::cout << "\t" << std::setw(11) << restarts.getSSE(restarts.getBestRun());
+            #endif
+            #ifdef COUNT_DISTANCES
+            std::cout << "\t" << std::setw(11) << "-";
+            #endif
+            std::cout << std::endl;
+
+            for (int r = 0; r < runs; ++r) {
+                std::cerr << "restart " << r << ": " << restarts.getIterations(r) << " iterations, sse = "
+                          << restarts.getSSE(r) << (restarts.isAbandoned(r) ? " (abandoned)" : "")
+                          << (r == restarts.getBestRun() ? " (best)" : "") << std::endl;
+                delete initialCenters[r];
+            }
+            delete [] initialCenters;
+        } else if (command == "ksweep") {
+            int kMin, kMax, kStep;
+            std::cin >> kMin >> kMax >> kStep;
+
+            if (x == NULL) {
+                std::cerr << "Please load a dataset first" << std::endl;
+                continue;
+            }
+            if (kMin < 1 || kMax < 1 || kStep == 0 || std::max(kMin, kMax) > x->n) {
+                std::cerr << "Invalid ksweep parameters" << std::endl;
+                continue;
+            }
+
+            KSweep sweep;
+            sweep.initialize(x, numThreads);
+            std::vector<int> kValues;
+            std::vector<double> curve;
+            for (int sweepK = kMin; (kStep > 0) ? (sweepK <= kMax) : (sweepK >= kMax); sweepK += kStep) {
+                std::ostringstream name;
+                name << sweep.getName() << " k=" << sweepK;
+                std::cout << std::setw(35) << name.str() << "\t" << std::flush;
+
+                rusage start_clustering_time = get_time();
+                double start_clustering_wall_time = get_wall_time();
+                int iterations = sweep.run(sweepK, maxIterations);
+                double cluster_time = elapsed_time(&start_clustering_time);
+                double cluster_wall_time = get_wall_time() - start_clustering_wall_time;
+
+                std::cout << std::setw(5) << iterations << "\t";
+                std::cout << std::setw(10) << numThreads << "\t";
+                std::cout << std::setw(10) << cluster_time << "\t";
+                std::cout << std::setw(10) << cluster_wall_time << "\t";
+                std::cout << std::setw(8) << (getMemoryUsage() / 1024.0);
+                #ifdef MONITOR_ACCURACY
+                std::cout << "\t" << std::setw(11) << sweep.getSSE();
+                #endif
+                #ifdef COUNT_DISTANCES
+                std::cout << "\t" << std::setw(11) << "-";
+                #endif
+                std::cout << std::endl;
+
+                kValues.push_back(sweepK);
+                curve.push_back(sweep.getSSE());
+            }
+
+            // the objective curve
+            std::cout << "k\tsse" << std::endl;
+            for (size_t v = 0; v < kValues.size(); ++v) {
+                std::cout << kValues[v] << "\t" << curve[v] << std::endl;
+            }
+        } else if (command == "serve") {
+            int maxNeighbors;
+            std::cin >> maxNeighbors;
+
+            if (x == NULL || outCenters == NULL) {
+                std::cerr << "Please load a dataset and initialize first" << std::endl;
+                continue;
+            }
+
+            // Label the dataset with the current centers, by assign() and by
+            // a CenterIndex (whose build time is included)
+            unsigned short *labels[2];
+            for (int method = 0; method < 2; ++method) {
+                std::ostringstream name;
+                if (method == 0) {
+                    name << "assign";
+                } else {
+                    name << "centerindex L=" << maxNeighbors;
+                }
+                std::cout << std::setw(35) << name.str() << "\t" << std::flush;
+
+                labels[method] = new unsigned short[x->n];
+                rusage start_time = get_time();
+                double start_wall_time = get_wall_time();
+                if (method == 0) {
+                    assign(*x, *outCenters, labels[method], numThreads);
+                } else {
+                    CenterIndex index(*outCenters, maxNeighbors);
+                    index.nearest(*x, labels[method], NULL, numThreads);
+                }
+                double label_time = elapsed_time(&start_time);
+                double label_wall_time = get_wall_time() - start_wall_time;
+
+                std::cout << std::setw(5) << "-" << "\t";
+                std::cout << std::setw(10) << numThreads << "\t";
+                std::cout << std::setw(10) << label_time << "\t";
+                std::cout << std::setw(10) << label_wall_time << "\t";
+                std::cout << std::setw(8) << (getMemoryUsage() / 1024.0);
+                std::cout << std::endl;
+            }
+
+            if (! std::equal(labels[0], labels[0] + x->n, labels[1])) {
+                std::cerr << "ERROR: centerindex labels differ from assign()" << std::endl;
+            }
+            delete [] labels[0];
+            delete [] labels[1];
+        } else if (command == "save_model") {
+            std::string modelFileName;
+            std::cin >> modelFileName;
+
+            if (x == NULL || outCenters == NULL) {
+                std::cerr << "Please load a dataset and initialize first" << std::endl;
+                continue;
+            }
+
+            // Store the assignment of the last run, or (if there was none
+            // since initializing) the one to the initial centers
+            unsigned short *labels = outAssignment;
+            if (modelAlgorithm.empty()) {
+                labels = new unsigned short[x->n];
+                assign(*x, *outCenters, labels, numThreads);
+            }
+            double sse = 0.0;
+            for (int i = 0; i < x->n; ++i) {
+                sse += distance2(x->data + i * x->d, outCenters->data + labels[i] * x->d, x->d);
+            }
+
+            std::ostringstream config;
+            config << "k=" << outCenters->n << " init=" << initMethod
+                   << " threads=" << numThreads << " n=" << x->n;
+            if (maxIterations != std::numeric_limits<int>::max()) {
+                config << " maxiterations=" << maxIterations;
+            }
+            std::string name = modelAlgorithm.empty() ? "initial" : modelAlgorithm;
+            if (KmeansModel::save(modelFileName, *outCenters, labels, x->n, NULL,
+                        name, config.str(), modelIterations, sse)) {
+                std::cout << "saved model " << modelFileName << ": k = " << outCenters->n
+                          << ", d = " << outCenters->d << ", algorithm = " << name << std::endl;
+            } else {
+                std::cerr << "Unable to write model file: " << modelFileName << std::endl;
+            }
+            if (labels != outAssignment) {
+                delete [] labels;
+            }
+        } else if (command == "load_model") {
+            std::string modelFileName;
+            std::cin >> modelFileName;
+
+            double start_wall_time = get_wall_time();
+            KmeansModel model;
+            if (! model.load(modelFileName)) {
+                std::cerr << "Unable to read model file: " << modelFileName << std::endl;
+                continue;
+            }
+            if (x == NULL || model.getD() != x->d) {
+                std::cerr << "Please load a dataset of dimension " << model.getD() << " first" << std::endl;
+                continue;
+            }
+
+            // Warm start: the model's centers become the initial centers, and
+            // its assignment (if it has one for this many records) is kept
+            xcNdx++;
+            k = model.getK();
+            delete initialCenters;
+            delete outCenters;
+            delete [] outAssignment;
+            initialCenters = model.getCenters();
+            outCenters = model.getCenters();
+            outAssignment = new unsigned short[x->n];
+            if (model.getAssignment() && model.getN() == x->n) {
+                std::copy(model.getAssignment(), model.getAssignment() + x->n, outAssignment);
+            } else {
+                std::fill(outAssignment, outAssignment + x->n, 0);
+            }
+            initMethod = "model";
+            modelAlgorithm.clear();
+            modelIterations = 0;
+
+            std::cout << "loaded model " << modelFileName << ": k = " << k << ", d = " << model.getD()
+                      << ", algorithm = " << model.getAlgorithm() << " (" << model.getConfig() << ")"
+                      << ", " << (get_wall_time() - start_wall_time) << " secs" << std::endl;
+        } else if (command == "centerindex") {
+            std::string setting;
+            std::cin >> setting;
+            if (setting == "on" || setting == "off") {
+                useCenterIndex = (setting == "on");
+            } else {
+                std::cerr << "Invalid centerindex setting: " << setting << std::endl;
+            }
+        } else if (command == "kernelcache") {
+            std::cin >> kernelCacheMB;
+            if (kernelCacheMB < 0.0) {
+                kernelCacheMB = 0.0;
+            }
+        } else if (command == "kernelcutoff") {
+            double threshold;
+            std::cin >> threshold;
+            if (threshold >= 0.0 && threshold < 1.0) {
+                kernelCutoff = threshold;
+            } else {
+                std::cerr << "Invalid kernelcutoff threshold: " << threshold << std::endl;
+            }
+        } else if (command == "kernelincremental") {
+            std::string setting;
+            std::cin >> setting;
+            if (setting == "on" || setting == "off") {
+                kernelIncremental = (setting == "on");
+            } else {
+                std::cerr << "Invalid kernelincremental setting: " << setting << std::endl;
+            }
+        } else if (command == "kernel" || command == "elkan_kernel" || command == "hamerly_kernel") {
             std::string kernelType;
             std::cin >> kernelType;
+
+            // In the approximate modes, the records are mapped to explicit
+            // features, which an original-space algorithm clusters
+            std::string featureType;
+            int numFeatures = 0;
+            unsigned long long featureSeed = 0;
+            std::string featureAlgorithm;
+            if (command == "kernel" && kernelType == "nystrom") {
+                std::cin >> numFeatures >> featureAlgorithm >> kernelType;
+                featureType = "nystrom";
+            } else if (command == "kernel" && kernelType == "fourier") {
+                std::cin >> numFeatures >> featureSeed >> featureAlgorithm >> kernelType;
+                featureType = "fourier";
+            }
+
             Kernel const *kernel = NULL;
             if (kernelType == "gaussian") {
                 double tau;
@@ -249,17 +696,81 @@ int main(int argc, char **argv) {
                 std::cerr << "Invalid kernel specification" << std::endl;
                 continue;
             }
+
+            if (! featureAlgorithm.empty()) {
+                Kmeans *featureKmeans = originalSpaceAlgorithm(featureAlgorithm, k, useCenterIndex);
+                GaussianKernel const *gaussian = dynamic_cast<GaussianKernel const *>(kernel);
+                if (featureType == "fourier" && gaussian == NULL) {
+                    std::cerr << "Random Fourier features need a gaussian kernel" << std::endl;
+                    delete featureKmeans;
+                    delete kernel;
+                    continue;
+                }
+                if (x == NULL || initialCenters == NULL || numFeatures < 1 || featureKmeans == NULL) {
+                    std::cerr << "Invalid approximate kernel run (load a dataset and initialize first)" << std::endl;
+                    delete featureKmeans;
+                    delete kernel;
+                    continue;
+                }
+
+                // Map the records and the initial centers to features, and
+                // report the time taken
+                rusage start_time = get_time();
+                double start_wall_time = get_wall_time();
+                KernelFeatures *features = NULL;
+                if (featureType == "nystrom") {
+                    features = new NystromFeatures(*x, *kernel, numFeatures);
+                } else {
+                    features = new RandomFourierFeatures(*gaussian, x->d, numFeatures, featureSeed);
+                }
+                std::cout << std::setw(35) << features->getName() << "\t" << std::flush;
+                Dataset *xFeatures = features->transform(*x, numThreads);
+                Dataset *centerFeatures = features->transform(*initialCenters, numThreads);
+                double features_time = elapsed_time(&start_time);
+                double features_wall_time = get_wall_time() - start_wall_time;
+                std::cout << std::setw(5) << "-" << "\t";
+                std::cout << std::setw(10) << numThreads << "\t";
+                std::cout << std::setw(10) << features_time << "\t";
+                std::cout << std::setw(10) << features_wall_time << "\t";
+                std::cout << std::setw(8) << (getMemoryUsage() / 1024.0);
+                std::cout << std::endl;
+
+                execute(command, featureKmeans, xFeatures, k, centerFeatures,
+                        outAssignment, NULL,
+                        xcNdx, numThreads, maxIterations, &numItersHistory
+                        #ifdef MONITOR_ACCURACY
+                        , &sseHistory
+                        #endif
+                       );
+
+                delete featureKmeans;
+                delete xFeatures;
+                delete centerFeatures;
+                delete features;
+                delete kernel;
+                continue;
+            }
+
+            KernelKmeans *kernelAlgorithm = NULL;
             if (command == "kernel") {
-                algorithm = new NaiveKernelKmeans(kernel);
+                kernelAlgorithm = new NaiveKernelKmeans(kernel);
             } else if (command == "elkan_kernel") {
-                algorithm = new ElkanKernelKmeans(kernel);
+                kernelAlgorithm = new ElkanKernelKmeans(kernel);
+            } else if (command == "hamerly_kernel") {
+                kernelAlgorithm = new HamerlyKernelKmeans(kernel);
             } else {
                 delete kernel;
                 continue;
             }
+            kernelAlgorithm->setKernelCacheSize((size_t)(kernelCacheMB * 1024 * 1024));
+            kernelAlgorithm->setIncremental(kernelIncremental);
+            kernelAlgorithm->setKernelThreshold(kernelCutoff);
+            algorithm = kernelAlgorithm;
         } else if (command == "center") {
             std::cout << "centering dataset" << std::endl;
             centerDataset(x);
+            delete kdTree;
+            kdTree = NULL;
         } else if (command == "dump_assignment") {
             if (outAssignment) {
                 for (int i = 0; i < x->n; ++i) {
@@ -281,25 +792,33 @@ int main(int argc, char **argv) {
         }
 
         if (algorithm) {
-            execute(command, algorithm, x, k, assignment, 
+            std::string name = algorithm->getName();
+            int iterations = execute(command, algorithm, x, k, initialCenters,
                     outAssignment, outCenters,
                     xcNdx, numThreads, maxIterations, &numItersHistory
                     #ifdef MONITOR_ACCURACY
                     , &sseHistory
                     #endif
                    );
+            if (iterations >= 0) {
+                modelAlgorithm = name;
+                modelIterations = iterations;
+            }
             delete algorithm;
             algorithm = NULL;
         }
     }
 
+    delete kdTree;
     delete x;
-    delete [] assignment;
+    delete initialCenters;
+    delete [] outAssignment;
+    delete outCenters;
 
     return 0;
 }
 
-void execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned short k, unsigned short const *assignment,
+int execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned short k, Dataset const *initialCenters,
         unsigned short *outAssignment, Dataset *outCenters,
         int xcNdx,
         int numThreads,
@@ -310,13 +829,13 @@ void execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned
         #endif
         ) {
     // Check for missing initialization
-    if (assignment == NULL) {
+    if (initialCenters == NULL) {
         std::cerr << "initialize centers first!" << std::endl;
-        return;
+        return -1;
     }
     if (x == NULL) {
         std::cerr << "load a dataset first!\n" << std::endl;
-        return;
+        return -1;
     }
 
     #ifdef COUNT_DISTANCES
@@ -330,14 +849,14 @@ void execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned
     // Begin executing algorithm
     std::cout << std::setw(35) << algorithm->getName() << "\t" << std::flush;
 
-    // Make a working copy of the set of centers
+    // The assignment to work on
     unsigned short *workingAssignment = outAssignment ? outAssignment : new unsigned short[x->n];
-    std::copy(assignment, assignment + x->n, workingAssignment);
 
-    // Time the execution and get the number of iterations
+    // Time the execution (including the initial assignment) and get the
+    // number of iterations
     rusage start_clustering_time = get_time();
     double start_clustering_wall_time = get_wall_time();
-    algorithm->initialize(x, k, workingAssignment, numThreads);
+    algorithm->initialize(x, *initialCenters, workingAssignment, numThreads);
     int iterations = algorithm->run(maxIterations);
 
     if (outCenters) {
@@ -354,6 +873,93 @@ void execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned
     double cluster_wall_time = get_wall_time() - start_clustering_wall_time;
 
     // Report results
+    std::cout << std::setw(5) << iterations << "\t";
+    std::cout << std::setw(10) << numThreads << "\t";
+    std::cout << std::setw(10) << cluster_time << "\t";
+    std::cout << std::setw(10) << cluster_wall_time << "\t";
+    std::cout << std::setw(8) << (getMemoryUsage() / 1024.0); // from kilo to mega
+
+    // Mini-batch k-means is approximate, so neither its SSE nor its number of
+    // batches is compared with the other algorithms' (or recorded for them)
+    bool approximate = dynamic_cast<MiniBatchKmeans *>(algorithm) != NULL;
+
+    #ifdef MONITOR_ACCURACY
+    if (! approximate) {
+        double sse = algorithm->getSSE();
+        std::cout << "\t" << std::setw(11) << sse;
+
+        // verification that we get the same distortion with different
+        // algorithms. The kd-tree algorithm adds whole subtrees' cached sums
+        // to the new centers, so its centers (and SSE) match Lloyd's only to
+        // rounding; it is checked with a tolerance, and does not become the
+        // SSE the other algorithms are checked against. The kernel algorithms
+        // sum the same kernel values in different orders (with incremental or
+        // rebuilt cluster statistics, and with or without the kernel cache),
+        // so they are checked against each other with a tolerance.
+        bool kdTree = dynamic_cast<KdTreeKmeans *>(algorithm) != NULL;
+        bool exactSums = ! kdTree && dynamic_cast<KernelKmeans *>(algorithm) == NULL;
+        if (! kdTree) {
+            while (sseHistory->size() <= (size_t)xcNdx) {
+                sseHistory->push_back(sse);
+            }
+        }
+        if (sseHistory->size() > (size_t)xcNdx) {
+            double reference = (*sseHistory)[xcNdx];
+            if (exactSums ? (sse != reference) : (fabs(sse - reference) > SSE_TOLERANCE * reference)) {
+                std::cerr << "ERROR: sse = " << sse << " but last SSE was " << reference << std::endl;
+            }
+        }
+    } else {
+        std::cout << "\t" << std::setw(11) << algorithm->getSSE();
+    }
+    #endif
+    #ifdef COUNT_DISTANCES
+    {
+        std::cout << "\t" << std::setw(11) << numDistances;
+    }
+    #endif
+
+    // verification that we get the same number of iterations with different algorithms
+    if (! approximate) {
+        while (numItersHistory->size() <= (size_t)xcNdx) {
+            numItersHistory->push_back(iterations);
+        }
+        if (iterations != numItersHistory->back()) {
+            std::cerr << "ERROR: iterations = " << iterations << " but last iterations was " << numItersHistory->back() << std::endl;
+        }
+    }
+
+    std::cout << std::endl;
+
+    if (!outAssignment)
+        delete [] workingAssignment;
+
+    return iterations;
+}
+
+
+void executeStreaming(StreamingKmeans *algorithm, ChunkedDataset *source, Dataset const &initialCenters,
+        int xcNdx, int numThreads, int maxIterations,
+        std::vector<int> *numItersHistory
+        #ifdef MONITOR_ACCURACY
+        , std::vector<double> *sseHistory
+        #endif
+        ) {
+    std::cout << std::setw(35) << algorithm->getName() << "\t" << std::flush;
+
+    rusage start_clustering_time = get_time();
+    double start_clustering_wall_time = get_wall_time();
+    algorithm->initialize(source, initialCenters, numThreads);
+    int iterations = algorithm->run(maxIterations);
+    double cluster_time = elapsed_time(&start_clustering_time);
+    double cluster_wall_time = get_wall_time() - start_clustering_wall_time;
+
+    if (iterations < 0) {
+        std::cout << std::endl;
+        std::cerr << "Unable to read data file while clustering" << std::endl;
+        return;
+    }
+
     std::cout << std::setw(5) << iterations << "\t";
     std::cout << std::setw(10) << numThreads << "\t";
     std::cout << std::setw(10) << cluster_time << "\t";
@@ -364,7 +970,6 @@ void execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned
         double sse = algorithm->getSSE();
         std::cout << "\t" << std::setw(11) << sse;
 
-        // verification that we get the same distortion with different algorithms
         while (sseHistory->size() <= (size_t)xcNdx) {
             sseHistory->push_back(sse);
         }
@@ -375,11 +980,11 @@ void execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned
     #endif
     #ifdef COUNT_DISTANCES
     {
-        std::cout << "\t" << std::setw(11) << numDistances;
+        // distances are not counted when streaming
+        std::cout << "\t" << std::setw(11) << "-";
     }
     #endif
 
-    // verification that we get the same number of iterations with different algorithms
     while (numItersHistory->size() <= (size_t)xcNdx) {
         numItersHistory->push_back(iterations);
     }
@@ -388,8 +993,4 @@ void execute(std::string command, Kmeans *algorithm, Dataset const *x, unsigned
     }
 
     std::cout << std::endl;
-
-    if (!outAssignment)
-        delete [] workingAssignment;
 }
-
@@ -0,0 +1,184 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+/* This program writes a synthetic dataset to standard output, in the text
+ * format read by the dataset command of driver-experiment. Usage:
+ *
+ * driver-generate KIND n d k seed
+ *
+ * where KIND is one of:
+ *
+ * gaussian -- a mixture of k spherical gaussians with unit variance, whose
+ *     means are uniform in the cube [-SPREAD, SPREAD]^d
+ * uniform -- points uniform in the same cube (k is ignored)
+ * anisotropic -- like gaussian, but each cluster is stretched by its own
+ *     scale along each axis (from 0.1 to 10) of a random rotation shared by
+ *     all clusters
+ * heavytailed -- like gaussian, but each cluster is a multivariate Student t
+ *     distribution with 2 degrees of freedom (which has infinite variance)
+ *
+ * Each point's cluster is chosen uniformly at random. The same arguments
+ * always give the same dataset.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// The cluster means are uniform in [-SPREAD, SPREAD]^d.
+static const double SPREAD = 10.0;
+
+// Random numbers from a seeded generator.
+class Random {
+    public:
+        Random(unsigned long long seed) : generator(seed), haveSpare(false), spare(0.0) {}
+
+        // A uniform random number in (0, 1).
+        double uniform() { return ((generator() >> 11) + 0.5) / 9007199254740992.0; } // 2^53
+
+        // A standard normal random number, by the Box-Muller transform.
+        double normal() {
+            if (haveSpare) {
+                haveSpare = false;
+                return spare;
+            }
+            double r = sqrt(-2.0 * log(uniform()));
+            double angle = 2.0 * M_PI * uniform();
+            spare = r * sin(angle);
+            haveSpare = true;
+            return r * cos(angle);
+        }
+
+        // A uniform random integer in [0, n).
+        int index(int n) { return (int)(uniform() * n); }
+
+    private:
+        std::mt19937_64 generator;
+        bool haveSpare;
+        double spare;
+};
+
+// Fill the d x d row-major matrix q with a random rotation (Gram-Schmidt
+// applied to a gaussian matrix).
+static void random_rotation(Random &random, int d, std::vector<double> &q) {
+    q.resize(d * d);
+    for (int r = 0; r < d; ++r) {
+        double *row = q.data() + r * d;
+        double norm2 = 0.0;
+        while (norm2 < 1e-12) {
+            for (int c = 0; c < d; ++c) {
+                row[c] = random.normal();
+            }
+            for (int p = 0; p < r; ++p) {
+                double const *prev = q.data() + p * d;
+                double dot = 0.0;
+                for (int c = 0; c < d; ++c) {
+                    dot += row[c] * prev[c];
+                }
+                for (int c = 0; c < d; ++c) {
+                    row[c] -= dot * prev[c];
+                }
+            }
+            norm2 = 0.0;
+            for (int c = 0; c < d; ++c) {
+                norm2 += row[c] * row[c];
+            }
+        }
+        double norm = sqrt(norm2);
+        for (int c = 0; c < d; ++c) {
+            row[c] /= norm;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 6) {
+        std::cerr << "usage: " << argv[0] << " [gaussian|uniform|anisotropic|heavytailed] n d k seed" << std::endl;
+        return 1;
+    }
+
+    std::string kind(argv[1]);
+    int n = atoi(argv[2]);
+    int d = atoi(argv[3]);
+    int k = atoi(argv[4]);
+    unsigned long long seed = strtoull(argv[5], NULL, 10);
+
+    if (kind != "gaussian" && kind != "uniform" && kind != "anisotropic" && kind != "heavytailed") {
+        std::cerr << "Invalid kind of dataset: " << kind << std::endl;
+        return 1;
+    }
+    if (n < 1 || d < 1 || k < 1) {
+        std::cerr << "Invalid dataset size: n = " << n << ", d = " << d << ", k = " << k << std::endl;
+        return 1;
+    }
+
+    Random random(seed);
+
+    // the cluster means, and for anisotropic clusters, their scales and the
+    // shared rotation
+    std::vector<double> means(k * d), scales, rotation;
+    for (int i = 0; i < k * d; ++i) {
+        means[i] = SPREAD * (2.0 * random.uniform() - 1.0);
+    }
+    if (kind == "anisotropic") {
+        scales.resize(k * d);
+        for (int i = 0; i < k * d; ++i) {
+            scales[i] = pow(10.0, 2.0 * random.uniform() - 1.0);
+        }
+        random_rotation(random, d, rotation);
+    }
+
+    std::cout << n << " " << d << std::endl;
+    std::cout << std::setprecision(10);
+    std::vector<double> z(d), p(d);
+    for (int i = 0; i < n; ++i) {
+        if (kind == "uniform") {
+            for (int dim = 0; dim < d; ++dim) {
+                p[dim] = SPREAD * (2.0 * random.uniform() - 1.0);
+            }
+        } else {
+            int j = random.index(k);
+            double const *mean = means.data() + j * d;
+            for (int dim = 0; dim < d; ++dim) {
+                z[dim] = random.normal();
+            }
+
+            if (kind == "anisotropic") {
+                // stretch, then rotate
+                double const *scale = scales.data() + j * d;
+                for (int dim = 0; dim < d; ++dim) {
+                    z[dim] *= scale[dim];
+                }
+                for (int dim = 0; dim < d; ++dim) {
+                    double const *row = rotation.data() + dim * d;
+                    double v = 0.0;
+                    for (int c = 0; c < d; ++c) {
+                        v += row[c] * z[c];
+                    }
+                    p[dim] = mean[dim] + v;
+                }
+            } else {
+                // a chi-square variable with 2 degrees of freedom, divided by
+                // 2, is -log(U)
+                double scale = (kind == "heavytailed") ? 1.0 / sqrt(-log(random.uniform())) : 1.0;
+                for (int dim = 0; dim < d; ++dim) {
+                    p[dim] = mean[dim] + scale * z[dim];
+                }
+            }
+        }
+
+        for (int dim = 0; dim < d; ++dim) {
+            std::cout << (dim ? " " : "") << p[dim];
+        }
+        std::cout << "\n";
+    }
+
+    return 0;
+}
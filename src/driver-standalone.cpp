@@ -13,6 +13,8 @@
 #include "general_functions.h"
 #include "hamerly_kmeans.h"
 #include "heap_kmeans.h"
+#include "kdtree_kmeans.h"
+#include "minibatch_kmeans.h"
 #include "naive_kmeans.h"
 #include "sort_kmeans.h"
 
@@ -36,13 +38,15 @@ Kmeans *get_algorithm(std::string const &name) {
     if (name == "compare") return new CompareKmeans();
     if (name == "sort") return new SortKmeans();
     if (name == "heap") return new HeapKmeans();
+    if (name == "kdtree") return new KdTreeKmeans();
+    if (name == "minibatch") return new MiniBatchKmeans();
     assert(false);
     return NULL;
 }
 
 int main(int argc, char **argv) {
-    if (argc != 5) {
-        std::cout << "usage: " << argv[0] << " algorithm dataset k [centers|assignment]\n";
+    if (argc < 5 || argc > 7) {
+        std::cout << "usage: " << argv[0] << " algorithm dataset k [centers|assignment] [kpp|random|afkmc2 [M]]\n";
         return 1;
     }
 
@@ -50,17 +54,24 @@ int main(int argc, char **argv) {
     std::string filename(argv[2]);
     int k = std::stoi(argv[3]);
     std::string output(argv[4]);
+    std::string init_name(argc > 5 ? argv[5] : "kpp");
 
     Dataset *x = load_dataset(filename);
     Kmeans *algorithm = get_algorithm(algorithm_name);
 
-    Dataset *initialCenters = init_centers_kmeanspp_v2(*x, k);
+    Dataset *initialCenters;
+    if (init_name == "random") {
+        initialCenters = init_centers(*x, k);
+    } else if (init_name == "afkmc2") {
+        initialCenters = init_centers_afkmc2(*x, k, argc > 6 ? std::stoi(argv[6]) : 200);
+    } else {
+        assert(init_name == "kpp");
+        initialCenters = init_centers_kmeanspp_v2(*x, k);
+    }
 
     unsigned short *assignment = new unsigned short[x->n];
 
-    assign(*x, *initialCenters, assignment);
-
-    algorithm->initialize(x, k, assignment, 1);
+    algorithm->initialize(x, *initialCenters, assignment, 1);
 
     algorithm->run(10000);
 
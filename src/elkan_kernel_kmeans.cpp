@@ -40,8 +40,7 @@ int ElkanKernelKmeans::runThread(int threadId, int maxIterations) {
     int endNdx = end(threadId);
 
     // precompute the (kernelized) inner product of each center with itself
-    computeMemberships(threadId, &memberships, &cc);
-    synchronizeAllThreads();
+    updateClusterStatistics(threadId, false);
 
     while ((iterations < maxIterations) && ! converged) {
         ++iterations;
@@ -104,16 +103,7 @@ int ElkanKernelKmeans::runThread(int threadId, int maxIterations) {
         }
 
         // compute center movements and update upper and lower bounds
-        computeMemberships(threadId, &newMemberships, &newCc);
-        synchronizeAllThreads();
-        computeCenterMovement(threadId);
-        synchronizeAllThreads();
-
-        if (threadId == 0) {
-            memberships.swap(newMemberships);
-            cc.swap(newCc);
-        }
-        synchronizeAllThreads();
+        updateClusterStatistics(threadId, true);
         update_center_dists(threadId);
         synchronizeAllThreads();
 
@@ -138,11 +128,6 @@ void ElkanKernelKmeans::initialize(Dataset const *aX, unsigned short aK, unsigne
     std::fill(s, s + k, 0.0);
     std::fill(upper, upper + n, std::numeric_limits<double>::max());
     std::fill(lower, lower + n * k, 0.0);
-
-    newMemberships.clear();
-    newMemberships.resize(k);
-    newCc.resize(k);
-    std::fill(newCc.begin(), newCc.end(), 0.0);
 }
 
 
@@ -156,9 +141,6 @@ void ElkanKernelKmeans::free() {
     s = NULL;
     upper = NULL;
     lower = NULL;
-
-    newMemberships.clear();
-    newCc.clear();
 }
 
 void ElkanKernelKmeans::update_bounds(int startNdx, int endNdx) {
@@ -170,14 +152,3 @@ void ElkanKernelKmeans::update_bounds(int startNdx, int endNdx) {
     }
 }
 
-
-void ElkanKernelKmeans::computeCenterMovement(int threadId) {
-    for (int j = 0; j < k; ++j) {
-        #ifdef USE_THREADS
-        if (j % numThreads != threadId) {
-            continue;
-        }
-        #endif
-        centerMovement[j] = sqrt(cc[j] - 2.0 * centerCenterInnerProductGeneral(memberships[j], newMemberships[j]) + newCc[j]);
-    }
-}
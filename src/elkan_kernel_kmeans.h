@@ -23,13 +23,13 @@ class ElkanKernelKmeans : public KernelKmeans {
             return out.str();
         }
         virtual void free();
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
 
     protected:
         int runThread(int threadId, int maxIterations);
         void update_bounds(int startNdx, int endNdx);
         void update_center_dists(int threadId);
-        void computeCenterMovement(int threadId);
 
         // Matrix in an array of distance between each center, divided by 2.
         double *centerCenterDistDiv2;
@@ -42,11 +42,6 @@ class ElkanKernelKmeans : public KernelKmeans {
 
         // Matrix in an array of k lower bounds for each point.
         double *lower;
-
-        // These are used to hold the new memberships and new squared center
-        // norms (Cc means <c,c>) from one iteration to the next.
-        std::vector<std::vector<unsigned int> > newMemberships;
-        std::vector<double> newCc;
 };
 
 #endif
@@ -106,6 +106,14 @@ void ElkanKmeans::update_bounds(int startNdx, int endNdx) {
     }
 }
 
+void ElkanKmeans::seed_bounds(std::pair<double, int> const *nearest, int m, int startNdx, int endNdx) {
+    // lower already holds the distances to all initial centers
+    for (int i = startNdx; i < endNdx; ++i) {
+        upper[i] = sqrt(nearest[i * m].first);
+    }
+    update_bounds(startNdx, endNdx);
+}
+
 void ElkanKmeans::initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads) {
     numLowerBounds = aK;
     TriangleInequalityBaseKmeans::initialize(aX, aK, initialAssignment, aNumThreads);
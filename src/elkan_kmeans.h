@@ -18,6 +18,7 @@ class ElkanKmeans : public TriangleInequalityBaseKmeans {
         ElkanKmeans() : centerCenterDistDiv2(NULL) {}
         virtual ~ElkanKmeans() { free(); }
         virtual void free();
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
         virtual std::string getName() const { return "elkan"; }
 
@@ -30,6 +31,11 @@ class ElkanKmeans : public TriangleInequalityBaseKmeans {
         // Update the upper and lower bounds for the range of points given.
         void update_bounds(int startNdx, int endNdx);
 
+        // The bounds need the distances to all initial centers, which become
+        // the lower bounds without being sorted or copied.
+        virtual bool seedsAllCenters() const { return true; }
+        virtual void seed_bounds(std::pair<double, int> const *nearest, int m, int startNdx, int endNdx);
+
         // Keep track of the distance (divided by 2) between each pair of
         // points.
         double *centerCenterDistDiv2;
@@ -14,6 +14,10 @@
 #include <cstring>
 #include <cstdio>
 #include <unistd.h>
+#include <limits>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
 
 void addVectors(double *a, double const *b, int d) {
     double const *end = a + d;
@@ -29,14 +33,10 @@ void subVectors(double *a, double const *b, int d) {
     }
 }
 
+// distance2() without counting the calculation (distance2() itself counts
+// nothing; algorithms count their own with COUNT_DISTANCES)
 double distance2silent(double const *a, double const *b, int d) {
-    double d2 = 0.0, diff;
-    double const *end = a + d; // one past the last valid entry in a
-    while (a < end) {
-        diff = *(a++) - *(b++);
-        d2 += diff * diff;
-    }
-    return d2;
+    return distance2(a, b, d);
 }
 
 
@@ -113,11 +113,7 @@ Dataset *init_centers_kmeanspp(Dataset const &x, unsigned short k) {
         // look for the point that is furthest from any center
         for (int i = 0; i < x.n; ++i) {
             int example = dist2[i].second;
-            double d2 = 0.0, diff;
-            for (int j = 0; j < x.d; ++j) {
-                diff = x(example,j) - x(chosen_pts[ndx - 1],j);
-                d2 += diff * diff;
-            }
+            double d2 = distance2(x.data + example * x.d, x.data + chosen_pts[ndx - 1] * x.d, x.d);
             if (d2 < dist2[i].first) {
                 dist2[i].first = d2;
             }
@@ -186,11 +182,7 @@ Dataset *init_centers_kmeanspp_v2(Dataset const &x, unsigned short k) {
         double max_dist = 0.0;
         for (int i = 0; i < x.n; ++i) {
             int example = dist2[i].second;
-            double d2 = 0.0, diff;
-            for (int j = 0; j < x.d; ++j) {
-                diff = x(example,j) - x(chosen_pts[ndx - 1],j);
-                d2 += diff * diff;
-            }
+            double d2 = distance2(x.data + example * x.d, x.data + chosen_pts[ndx - 1] * x.d, x.d);
             if (d2 < dist2[i].first) {
                 dist2[i].first = d2;
             }
@@ -237,6 +229,85 @@ Dataset *init_centers_kmeanspp_v2(Dataset const &x, unsigned short k) {
     return c;
 }
 
+// Sample an index from the cumulative distribution cdf (of length n, ending
+// at 1).
+static int sample_cdf(double const *cdf, int n) {
+    double r = (double)rand() / ((double)RAND_MAX + 1.0);
+    int ndx = (int)(std::upper_bound(cdf, cdf + n, r) - cdf);
+    return std::min(ndx, n - 1);
+}
+
+// The squared distance from record i to the closest of the first m centers
+// chosen.
+static double min_dist2(Dataset const &x, int i, int const *chosen_pts, int m) {
+    double best = std::numeric_limits<double>::max();
+    for (int c = 0; c < m; ++c) {
+        best = std::min(best, distance2(x.data + i * x.d, x.data + chosen_pts[c] * x.d, x.d));
+    }
+    return best;
+}
+
+Dataset *init_centers_afkmc2(Dataset const &x, unsigned short k, int chainLength) {
+    int *chosen_pts = new int[k];
+    double *cdf = new double[x.n];
+    chainLength = std::max(1, chainLength);
+
+    // choose the first point randomly
+    chosen_pts[0] = rand() % x.n;
+
+    // the proposal distribution q(x) = d(x, c_1)^2 / (2 sum d^2) + 1 / (2n),
+    // stored as q (in cdf) and then as its running sum
+    double sum_dist2 = 0.0;
+    for (int i = 0; i < x.n; ++i) {
+        cdf[i] = min_dist2(x, i, chosen_pts, 1);
+        sum_dist2 += cdf[i];
+    }
+    double running = 0.0;
+    for (int i = 0; i < x.n; ++i) {
+        double q = 0.5 / x.n + (sum_dist2 > 0.0 ? 0.5 * cdf[i] / sum_dist2 : 0.5 / x.n);
+        running += q;
+        cdf[i] = running;
+    }
+
+    for (int ndx = 1; ndx < k; ++ndx) {
+        int current = 0;
+        double current_weight = 0.0;
+        // a chain that only visits chosen centers is run again (a few times)
+        for (int attempt = 0; attempt < 10 && current_weight <= 0.0; ++attempt) {
+            current = sample_cdf(cdf, x.n);
+            double current_q = cdf[current] - (current > 0 ? cdf[current - 1] : 0.0);
+            double current_d2 = min_dist2(x, current, chosen_pts, ndx);
+            current_weight = current_d2 / current_q;
+            for (int step = 1; step < chainLength; ++step) {
+                int candidate = sample_cdf(cdf, x.n);
+                double candidate_q = cdf[candidate] - (candidate > 0 ? cdf[candidate - 1] : 0.0);
+                double candidate_weight = min_dist2(x, candidate, chosen_pts, ndx) / candidate_q;
+                // Metropolis-Hastings acceptance with target D^2
+                double r = (double)rand() / ((double)RAND_MAX + 1.0);
+                if (current_weight <= 0.0 || candidate_weight > r * current_weight) {
+                    current = candidate;
+                    current_weight = candidate_weight;
+                }
+            }
+        }
+        chosen_pts[ndx] = current;
+    }
+
+    Dataset *c = new Dataset(k, x.d);
+    for (int i = 0; i < c->n; ++i) {
+        double *cdp = c->data + i * x.d;
+        memcpy(cdp, x.data + chosen_pts[i] * x.d, sizeof(double) * x.d);
+        if (c->sumDataSquared) {
+            c->sumDataSquared[i] = std::inner_product(cdp, cdp + x.d, cdp, 0.0);
+        }
+    }
+
+    delete [] chosen_pts;
+    delete [] cdf;
+
+    return c;
+}
+
 
 /**
  * in MB
@@ -264,24 +335,202 @@ double getMemoryUsage() {
 }
 
 
-void assign(Dataset const &x, Dataset const &c, unsigned short *assignment) {
-    for (int i = 0; i < x.n; ++i) {
-        double shortestDist2 = std::numeric_limits<double>::max();
-        int closest = 0;
-        for (int j = 0; j < c.n; ++j) {
-            double d2 = 0.0, *a = x.data + i * x.d, *b = c.data + j * x.d;
-            for (; a != x.data + (i + 1) * x.d; ++a, ++b) {
-                d2 += (*a - *b) * (*a - *b);
+// assign() compares blocks of ASSIGN_POINT_BLOCK records against panels of
+// about ASSIGN_PANEL_DOUBLES values of the centers, so a panel stays in cache
+// while a block uses it. Within a block, ASSIGN_POINT_GROUP records at a time
+// are compared against each tile of ASSIGN_CENTER_TILE centers in the panel,
+// keeping all of their distances in registers.
+static const int ASSIGN_POINT_BLOCK = 256;
+static const int ASSIGN_PANEL_DOUBLES = 8192;
+static const int ASSIGN_POINT_GROUP = 4;
+static const int ASSIGN_CENTER_TILE = 4;
+
+struct AssignThreadInfo {
+    Dataset const *x;
+    int k;
+    // the centers, tile by tile; within a tile, dimension by dimension
+    double const *tiles;
+    unsigned short *assignment, *secondAssignment;
+    double *nearestDist;
+    int threadId, numThreads;
+    #ifdef USE_THREADS
+    pthread_t pthread_id;
+    #endif
+};
+
+int assignTilesSize(int k, int d) {
+    return (k + ASSIGN_CENTER_TILE - 1) / ASSIGN_CENTER_TILE * ASSIGN_CENTER_TILE * d;
+}
+
+void layoutAssignTiles(Dataset const &c, double *tiles) {
+    // the unused entries of the last tile are zero, and are never compared
+    std::fill(tiles, tiles + assignTilesSize(c.n, c.d), 0.0);
+    for (int j = 0; j < c.n; ++j) {
+        double *tile = tiles + (j / ASSIGN_CENTER_TILE) * ASSIGN_CENTER_TILE * c.d;
+        for (int dim = 0; dim < c.d; ++dim) {
+            tile[dim * ASSIGN_CENTER_TILE + j % ASSIGN_CENTER_TILE] = c(j, dim);
+        }
+    }
+}
+
+// Assign records [startNdx, endNdx) of x, as assignRange() does; findSecond
+// says whether to also keep the second-closest centers (which costs more, so
+// is done only if asked for).
+template <bool findSecond>
+static void assign_points(Dataset const &x, int k, double const *tiles, int startNdx, int endNdx,
+        unsigned short *assignment, double *nearestDist2, unsigned short *secondAssignment) {
+    int d = x.d;
+    int numTiles = (k + ASSIGN_CENTER_TILE - 1) / ASSIGN_CENTER_TILE;
+    int panelTiles = std::max(1, ASSIGN_PANEL_DOUBLES / (ASSIGN_CENTER_TILE * d));
+
+    double best[ASSIGN_POINT_BLOCK], second[ASSIGN_POINT_BLOCK];
+    int bestNdx[ASSIGN_POINT_BLOCK], secondNdx[ASSIGN_POINT_BLOCK];
+
+    for (int blockStart = startNdx; blockStart < endNdx; blockStart += ASSIGN_POINT_BLOCK) {
+        int blockSize = std::min(endNdx - blockStart, ASSIGN_POINT_BLOCK);
+        std::fill(best, best + blockSize, std::numeric_limits<double>::max());
+        std::fill(second, second + blockSize, std::numeric_limits<double>::max());
+        std::fill(bestNdx, bestNdx + blockSize, 0);
+        std::fill(secondNdx, secondNdx + blockSize, 0);
+
+        for (int panelStart = 0; panelStart < numTiles; panelStart += panelTiles) {
+            int panelEnd = std::min(numTiles, panelStart + panelTiles);
+
+            for (int g = 0; g < blockSize; g += ASSIGN_POINT_GROUP) {
+                // a short last group repeats its last record
+                double const *xp[ASSIGN_POINT_GROUP];
+                double gBest[ASSIGN_POINT_GROUP], gSecond[ASSIGN_POINT_GROUP];
+                int gBestNdx[ASSIGN_POINT_GROUP], gSecondNdx[ASSIGN_POINT_GROUP];
+                for (int p = 0; p < ASSIGN_POINT_GROUP; ++p) {
+                    int b = std::min(g + p, blockSize - 1);
+                    xp[p] = x.data + (blockStart + b) * d;
+                    gBest[p] = best[b];
+                    gSecond[p] = second[b];
+                    gBestNdx[p] = bestNdx[b];
+                    gSecondNdx[p] = secondNdx[b];
+                }
+
+                for (int t = panelStart; t < panelEnd; ++t) {
+                    // Each distance is summed over the dimensions in order,
+                    // as in distance2().
+                    double d2[ASSIGN_POINT_GROUP][ASSIGN_CENTER_TILE] = {};
+                    double const *cp = tiles + t * ASSIGN_CENTER_TILE * d;
+                    for (int dim = 0; dim < d; ++dim, cp += ASSIGN_CENTER_TILE) {
+                        for (int p = 0; p < ASSIGN_POINT_GROUP; ++p) {
+                            double xv = xp[p][dim];
+                            for (int j = 0; j < ASSIGN_CENTER_TILE; ++j) {
+                                double diff = xv - cp[j];
+                                d2[p][j] += diff * diff;
+                            }
+                        }
+                    }
+
+                    // Keep the closest centers without branches (which
+                    // would be mispredicted); the unused centers of the last
+                    // tile are never closer.
+                    int tileSize = std::min(k - t * ASSIGN_CENTER_TILE, ASSIGN_CENTER_TILE);
+                    for (int p = 0; p < ASSIGN_POINT_GROUP; ++p) {
+                        for (int j = 0; j < ASSIGN_CENTER_TILE; ++j) {
+                            double dist2 = j < tileSize ? d2[p][j] : std::numeric_limits<double>::max();
+                            int ndx = t * ASSIGN_CENTER_TILE + j;
+                            bool closest = dist2 < gBest[p];
+                            if (findSecond) {
+                                bool secondClosest = dist2 < gSecond[p];
+                                gSecond[p] = closest ? gBest[p] : (secondClosest ? dist2 : gSecond[p]);
+                                gSecondNdx[p] = closest ? gBestNdx[p] : (secondClosest ? ndx : gSecondNdx[p]);
+                            }
+                            gBest[p] = closest ? dist2 : gBest[p];
+                            gBestNdx[p] = closest ? ndx : gBestNdx[p];
+                        }
+                    }
+                }
+
+                int groupSize = std::min(blockSize - g, ASSIGN_POINT_GROUP);
+                for (int p = 0; p < groupSize; ++p) {
+                    best[g + p] = gBest[p];
+                    second[g + p] = gSecond[p];
+                    bestNdx[g + p] = gBestNdx[p];
+                    secondNdx[g + p] = gSecondNdx[p];
+                }
             }
-            if (d2 < shortestDist2) {
-                shortestDist2 = d2;
-                closest = j;
+        }
+
+        for (int b = 0; b < blockSize; ++b) {
+            int r = blockStart - startNdx + b;
+            assignment[r] = bestNdx[b];
+            if (nearestDist2) {
+                nearestDist2[r] = best[b];
+            }
+            if (findSecond) {
+                secondAssignment[r] = k > 1 ? secondNdx[b] : bestNdx[b];
             }
         }
-        assignment[i] = closest;
     }
 }
 
+void assignRange(Dataset const &x, int k, double const *tiles, int startNdx, int endNdx,
+        unsigned short *assignment, double *nearestDist2, unsigned short *secondAssignment) {
+    if (secondAssignment) {
+        assign_points<true>(x, k, tiles, startNdx, endNdx, assignment, nearestDist2, secondAssignment);
+    } else {
+        assign_points<false>(x, k, tiles, startNdx, endNdx, assignment, nearestDist2, secondAssignment);
+    }
+}
+
+static void *assign_runner(void *args) {
+    AssignThreadInfo *ti = (AssignThreadInfo *)args;
+    Dataset const &x = *ti->x;
+    int startNdx = (int)((long long)x.n * ti->threadId / ti->numThreads);
+    int endNdx = (int)((long long)x.n * (ti->threadId + 1) / ti->numThreads);
+    assignRange(x, ti->k, ti->tiles, startNdx, endNdx, ti->assignment + startNdx,
+            ti->nearestDist ? ti->nearestDist + startNdx : NULL,
+            ti->secondAssignment ? ti->secondAssignment + startNdx : NULL);
+    if (ti->nearestDist) {
+        for (int i = startNdx; i < endNdx; ++i) {
+            ti->nearestDist[i] = sqrt(ti->nearestDist[i]);
+        }
+    }
+    return NULL;
+}
+
+void assign(Dataset const &x, Dataset const &c, unsigned short *assignment,
+        int numThreads, double *nearestDist, unsigned short *secondAssignment) {
+    // Lay out the centers tile by tile, each tile dimension by dimension.
+    double *tiles = new double[assignTilesSize(c.n, x.d)];
+    layoutAssignTiles(c, tiles);
+
+    #ifdef USE_THREADS
+    int threads = std::max(1, std::min(numThreads, x.n));
+    #else
+    int threads = 1;
+    #endif
+    AssignThreadInfo *info = new AssignThreadInfo[threads];
+    for (int t = 0; t < threads; ++t) {
+        info[t].x = &x;
+        info[t].k = c.n;
+        info[t].tiles = tiles;
+        info[t].assignment = assignment;
+        info[t].secondAssignment = secondAssignment;
+        info[t].nearestDist = nearestDist;
+        info[t].threadId = t;
+        info[t].numThreads = threads;
+    }
+
+    #ifdef USE_THREADS
+    for (int t = 0; t < threads; ++t) {
+        pthread_create(&info[t].pthread_id, NULL, assign_runner, &info[t]);
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(info[t].pthread_id, NULL);
+    }
+    #else
+    assign_runner(&info[0]);
+    #endif
+
+    delete [] info;
+    delete [] tiles;
+}
+
 rusage get_time() {
     rusage now;
     getrusage(RUSAGE_SELF, &now);
@@ -38,6 +38,22 @@ void addVectors(double *a, double const *b, int d);
  */
 void subVectors(double *a, double const *b, int d);
 
+/* The squared Euclidean distance between two vectors, summed in order of
+ * dimension.
+ *
+ * Parameters:
+ *  a, b -- the vectors
+ *  d -- the dimension
+ * Return value: the squared distance between a and b
+ */
+inline double distance2(double const *a, double const *b, int d) {
+    double d2 = 0.0;
+    for (int dim = 0; dim < d; ++dim) {
+        d2 += (a[dim] - b[dim]) * (a[dim] - b[dim]);
+    }
+    return d2;
+}
+
 /* Initialize the centers randomly. Choose random records from x as the initial
  * values for the centers. Assumes that c uses the sumDataSquared field.
  *
@@ -60,6 +76,21 @@ Dataset *init_centers(Dataset const &x, unsigned short k);
 Dataset *init_centers_kmeanspp(Dataset const &x, unsigned short k);
 Dataset *init_centers_kmeanspp_v2(Dataset const &x, unsigned short k);
 
+/* Initialize the centers using AFK-MC^2 (Bachem et al., "Fast and Provably
+ * Good Seedings for k-Means"), which approximates K-means++ with a short
+ * Markov chain per center instead of a pass over the data. After one pass to
+ * build the proposal distribution from the first (random) center, each center
+ * costs O(chainLength * k * d).
+ *
+ * Parameters:
+ *  x -- records that are being clustered (n * d)
+ *  k -- the number of centers to choose
+ *  chainLength -- the length of each Markov chain; longer chains are closer
+ *       to K-means++
+ * Return value: the chosen centers (k * d), which the caller must delete
+ */
+Dataset *init_centers_afkmc2(Dataset const &x, unsigned short k, int chainLength = 200);
+
 /* Print an array (templated). Convenience function.
  *
  * Parameters:
@@ -86,6 +117,47 @@ double elapsed_time(rusage *start);
 
 void centerDataset(Dataset *x);
 
-void assign(Dataset const &x, Dataset const &c, unsigned short *assignment);
+/* Assign each record in x to its closest center in c (ties going to the lower
+ * index). The records are divided among the threads, and each thread
+ * compares blocks of records against tiles of centers (stored dimension by
+ * dimension, so that the distances to a tile are computed with vector
+ * instructions); each distance is summed in the same order as in
+ * distance2(), so the result does not depend on the tiling or the
+ * number of threads.
+ *
+ * Parameters:
+ *  x -- records to assign (n * d)
+ *  c -- the centers (k * d)
+ *  assignment -- the closest center of each record (n)
+ *  numThreads -- the number of threads to use
+ *  nearestDist -- if not NULL, the distance from each record to its closest
+ *      center (n)
+ *  secondAssignment -- if not NULL, the second-closest center of each record
+ *      (n); the closest, if there is only one center
+ */
+void assign(Dataset const &x, Dataset const &c, unsigned short *assignment,
+        int numThreads = 1, double *nearestDist = NULL, unsigned short *secondAssignment = NULL);
+
+/* The pieces of assign(), for threads that are already running: lay out the
+ * centers c as assign() does, in an array of assignTilesSize(k, d) values,
+ * and then assign records [startNdx, endNdx) of x to the closest of the k
+ * laid-out centers, exactly as assign() would.
+ *
+ * Parameters (of assignRange()):
+ *  x -- records to assign (n * d)
+ *  k -- the number of centers
+ *  tiles -- the centers, laid out by layoutAssignTiles()
+ *  startNdx, endNdx -- the range of records to assign
+ *  assignment -- the closest center of each record in the range, indexed from
+ *      startNdx (endNdx - startNdx)
+ *  nearestDist2 -- if not NULL, the squared distance from each record in the
+ *      range to its closest center, indexed as assignment
+ *  secondAssignment -- if not NULL, the second-closest centers, indexed as
+ *      assignment
+ */
+int assignTilesSize(int k, int d);
+void layoutAssignTiles(Dataset const &c, double *tiles);
+void assignRange(Dataset const &x, int k, double const *tiles, int startNdx, int endNdx,
+        unsigned short *assignment, double *nearestDist2 = NULL, unsigned short *secondAssignment = NULL);
 
 #endif
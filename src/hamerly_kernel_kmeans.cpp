@@ -0,0 +1,156 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "hamerly_kernel_kmeans.h"
+#include <algorithm>
+#include <limits>
+
+void HamerlyKernelKmeans::update_s(int threadId) {
+    // find the distance from each center to its closest other center
+    for (int c1 = threadId; c1 < k; c1 += numThreads) {
+        s[c1] = std::numeric_limits<double>::max();
+        for (int c2 = 0; c2 < k; ++c2) {
+            if (c2 == c1) { continue; }
+
+            // divide by 2 here since we always use the inter-center
+            // distances divided by 2
+            double distDiv2 = sqrt(centerCenterDist2(c1, c2)) / 2.0;
+            if (distDiv2 < s[c1]) {
+                s[c1] = distDiv2;
+            }
+        }
+    }
+}
+
+int HamerlyKernelKmeans::runThread(int threadId, int maxIterations) {
+    int iterations = 0;
+
+    int startNdx = start(threadId);
+    int endNdx = end(threadId);
+
+    // precompute the (kernelized) inner product of each center with itself
+    updateClusterStatistics(threadId, false);
+
+    while ((iterations < maxIterations) && ! converged) {
+        ++iterations;
+
+        bool membershipChanged = false;
+
+        // we have converged... until we find out we haven't
+        synchronizeAllThreads();
+        if (threadId == 0) {
+            setConverged(true);
+        }
+        synchronizeAllThreads();
+
+        for (int i = startNdx; i < endNdx; ++i) {
+            unsigned short closest = assignment[i];
+
+            // if upper[i] is less than the greater of these two, then we can
+            // ignore record i
+            double upper_comparison_bound = std::max(s[closest], lower[i]);
+            if (upper[i] <= upper_comparison_bound) {
+                continue;
+            }
+
+            // otherwise, tighten the upper bound and check again
+            double u2 = pointCenterDist2(i, closest);
+            upper[i] = sqrt(u2);
+            if (upper[i] <= upper_comparison_bound) {
+                continue;
+            }
+
+            // find the closest and second-closest centers
+            double l2 = std::numeric_limits<double>::max();
+            for (int j = 0; j < k; ++j) {
+                if (j == closest) { continue; }
+
+                double dist2 = pointCenterDist2(i, j);
+                if (dist2 < u2) {
+                    l2 = u2;
+                    u2 = dist2;
+                    closest = j;
+                } else if (dist2 < l2) {
+                    l2 = dist2;
+                }
+            }
+
+            lower[i] = sqrt(l2);
+            if (assignment[i] != closest) {
+                upper[i] = sqrt(u2);
+                assignment[i] = closest;
+                membershipChanged = true;
+            }
+        }
+
+        verifyAssignment(iterations, startNdx, endNdx);
+
+        if (membershipChanged) {
+            setConverged(false);
+        }
+
+        synchronizeAllThreads();
+
+        if (converged) {
+            break;
+        }
+
+        // compute center movements and update upper and lower bounds
+        updateClusterStatistics(threadId, true);
+        update_s(threadId);
+        synchronizeAllThreads();
+
+        update_bounds(startNdx, endNdx);
+        synchronizeAllThreads();
+    }
+
+    return iterations;
+}
+
+void HamerlyKernelKmeans::initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads) {
+    KernelKmeans::initialize(aX, aK, initialAssignment, aNumThreads);
+
+    s = new double[k];
+    upper = new double[n];
+    lower = new double[n];
+
+    // start with invalid bounds and assignments which will force the first
+    // iteration of k-means to do all its standard work
+    std::fill(s, s + k, 0.0);
+    std::fill(upper, upper + n, std::numeric_limits<double>::max());
+    std::fill(lower, lower + n, 0.0);
+}
+
+void HamerlyKernelKmeans::free() {
+    KernelKmeans::free();
+    delete [] s;
+    delete [] upper;
+    delete [] lower;
+    s = NULL;
+    upper = NULL;
+    lower = NULL;
+}
+
+void HamerlyKernelKmeans::update_bounds(int startNdx, int endNdx) {
+    // find the two furthest-moving centers
+    int furthestMovingCenter = 0;
+    double longest = 0.0, secondLongest = 0.0;
+    for (int j = 0; j < k; ++j) {
+        if (longest < centerMovement[j]) {
+            secondLongest = longest;
+            longest = centerMovement[j];
+            furthestMovingCenter = j;
+        } else if (secondLongest < centerMovement[j]) {
+            secondLongest = centerMovement[j];
+        }
+    }
+
+    for (int i = startNdx; i < endNdx; ++i) {
+        upper[i] += centerMovement[assignment[i]];
+        lower[i] -= (assignment[i] == furthestMovingCenter) ? secondLongest : longest;
+    }
+}
+
@@ -0,0 +1,50 @@
+#ifndef HAMERLY_KERNEL_KMEANS_H
+#define HAMERLY_KERNEL_KMEANS_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * A kernelized version of Hamerly's algorithm. Like HamerlyKmeans, it keeps
+ * one upper bound (on the kernel-space distance to the assigned center) and
+ * one lower bound (on the distance to the second-closest center) per point,
+ * and only the distance from each center to its closest other center, so the
+ * bounds take O(n + k) memory rather than the O(nk + k^2) of
+ * ElkanKernelKmeans. The bounds are moved by the kernel-space center movement
+ * found by updateClusterStatistics().
+ */
+
+#include "kernel_kmeans.h"
+
+class HamerlyKernelKmeans : public KernelKmeans {
+    public:
+        HamerlyKernelKmeans(Kernel const *k) : KernelKmeans(k), s(NULL), upper(NULL), lower(NULL) {}
+        virtual ~HamerlyKernelKmeans() { free(); }
+        virtual std::string getName() const {
+            std::ostringstream out;
+            out << "hamerly_kernel(" << kernel.getName() << ")";
+            return out.str();
+        }
+        virtual void free();
+        using Kmeans::initialize;
+        virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
+
+    protected:
+        int runThread(int threadId, int maxIterations);
+        void update_bounds(int startNdx, int endNdx);
+        void update_s(int threadId);
+
+        // Distance between center j and its closest other center, divided by 2.
+        double *s;
+
+        // Upper bound for each point.
+        double *upper;
+
+        // Lower bound for each point, on the distance to its second-closest
+        // center.
+        double *lower;
+};
+
+#endif
+
@@ -7,6 +7,8 @@
 #include "hamerly_kmeans.h"
 #include "general_functions.h"
 #include <cmath>
+#include <algorithm>
+#include <limits>
 
 /* Hamerly's algorithm that is a 'simplification' of Elkan's, in that it keeps
  * the following bounds:
@@ -78,26 +80,47 @@ int HamerlyKmeans::runThread(int threadId, int maxIterations) {
 
             // now update the lower bound by looking at all other centers
             double l2 = std::numeric_limits<double>::max(); // the squared lower bound
-            for (int j = 0; j < k; ++j) {
-                if (j == closest) { continue; }
-
-                double dist2 = pointCenterDist2(i, j);
-
-                if (dist2 < u2) {
-                    // another center is closer than the current assignment
-
-                    // change the lower bound to be the current upper bound
-                    // (since the current upper bound is the distance to the
-                    // now-second-closest known center)
-                    l2 = u2;
-
-                    // adjust the upper bound and the current assignment
-                    u2 = dist2;
-                    closest = j;
-                } else if (dist2 < l2) {
-                    // we must reduce the lower bound on the distance to the
-                    // *second* closest center to x[i]
-                    l2 = dist2;
+            if (centerIndex) {
+                // the second-closest center is no further away than the
+                // center closest to the assigned one
+                std::pair<double, int> near[2];
+                double radius = upper[i] + 2.0 * s[closest];
+                int found = find_nearest_centers(i, 2, radius * radius, near, threadId);
+                if (found < std::min(2, k)) {
+                    found = find_nearest_centers(i, 2, std::numeric_limits<double>::max(), near, threadId);
+                }
+
+                // ties with the current assignment keep the assignment
+                u2 = near[0].first;
+                closest = near[0].second;
+                if (found > 1) {
+                    l2 = near[1].first;
+                    if ((l2 == u2) && (near[1].second == assignment[i])) {
+                        closest = assignment[i];
+                    }
+                }
+            } else {
+                for (int j = 0; j < k; ++j) {
+                    if (j == closest) { continue; }
+
+                    double dist2 = pointCenterDist2(i, j);
+
+                    if (dist2 < u2) {
+                        // another center is closer than the current assignment
+
+                        // change the lower bound to be the current upper bound
+                        // (since the current upper bound is the distance to the
+                        // now-second-closest known center)
+                        l2 = u2;
+
+                        // adjust the upper bound and the current assignment
+                        u2 = dist2;
+                        closest = j;
+                    } else if (dist2 < l2) {
+                        // we must reduce the lower bound on the distance to the
+                        // *second* closest center to x[i]
+                        l2 = dist2;
+                    }
                 }
             }
 
@@ -120,6 +143,7 @@ int HamerlyKmeans::runThread(int threadId, int maxIterations) {
         if (threadId == 0) {
             int furthestMovingCenter = move_centers();
             converged = (0.0 == centerMovement[furthestMovingCenter]);
+            update_center_index();
         }
 
         synchronizeAllThreads();
@@ -135,6 +159,17 @@ int HamerlyKmeans::runThread(int threadId, int maxIterations) {
 }
 
 
+/* Seed the bounds from the distances to the nearest and second-nearest
+ * initial centers, then move them as the centers moved to their means.
+ */
+void HamerlyKmeans::seed_bounds(std::pair<double, int> const *nearest, int m, int startNdx, int endNdx) {
+    for (int i = startNdx; i < endNdx; ++i) {
+        upper[i] = sqrt(nearest[i * m].first);
+        lower[i] = (m > 1) ? sqrt(nearest[i * m + 1].first) : std::numeric_limits<double>::max();
+    }
+    update_bounds(startNdx, endNdx);
+}
+
 /* This method does the following:
  *  - finds the furthest-moving center
  *  - finds the distances moved by the two furthest-moving centers
@@ -16,12 +16,16 @@ class HamerlyKmeans : public TriangleInequalityBaseKmeans {
     public:
         HamerlyKmeans() { numLowerBounds = 1; }
         virtual ~HamerlyKmeans() { free(); }
-        virtual std::string getName() const { return "hamerly"; }
+        virtual std::string getName() const { return useCenterIndex ? "hamerly+index" : "hamerly"; }
 
     protected:
         // Update the upper and lower bounds for the given range of points.
         void update_bounds(int startNdx, int endNdx);
 
+        // The bounds need the two nearest initial centers.
+        virtual int numSeedCenters(int aK) const { return 2; }
+        virtual void seed_bounds(std::pair<double, int> const *nearest, int m, int startNdx, int endNdx);
+
         virtual int runThread(int threadId, int maxIterations);
 };
 
@@ -23,6 +23,7 @@ class HeapKmeans : public TriangleInequalityBaseKmeans {
         HeapKmeans() : heaps(NULL), heapBounds(NULL) {}
         virtual ~HeapKmeans() { free(); }
         virtual void free();
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
         virtual std::string getName() const { return "heap"; }
 
@@ -0,0 +1,489 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "k_sweep.h"
+#include "general_functions.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+
+KSweep::KSweep() : x(NULL), n(0), d(0), numThreads(0), k(0), oldK(0),
+    xNorm2(NULL), centers(NULL), centerNorm2(NULL), centerMovement(NULL),
+    s(NULL), furthest(0), secondFurthest(0.0), sumNewCenters(NULL),
+    clusterSize(NULL), clusterSSE(NULL), assignment(NULL), upper(NULL),
+    lower(NULL), converged(false), sse(0.0) {}
+
+void KSweep::free() {
+    for (int t = 0; t < numThreads; ++t) {
+        delete [] sumNewCenters[t];
+        delete [] clusterSize[t];
+        delete [] clusterSSE[t];
+    }
+    delete [] sumNewCenters;
+    delete [] clusterSize;
+    delete [] clusterSSE;
+    delete [] xNorm2;
+    delete centers;
+    delete [] centerNorm2;
+    delete [] centerMovement;
+    delete [] s;
+    delete [] assignment;
+    delete [] upper;
+    delete [] lower;
+    sumNewCenters = NULL;
+    clusterSize = NULL;
+    clusterSSE = NULL;
+    xNorm2 = NULL;
+    centers = NULL;
+    centerNorm2 = centerMovement = s = NULL;
+    assignment = NULL;
+    upper = lower = NULL;
+    x = NULL;
+    n = d = numThreads = k = oldK = 0;
+    sse = 0.0;
+}
+
+void KSweep::initialize(Dataset const *aX, int aNumThreads) {
+    free();
+
+    x = aX;
+    n = x->n;
+    d = x->d;
+    #ifdef USE_THREADS
+    numThreads = aNumThreads;
+    #else
+    numThreads = 1;
+    #endif
+
+    xNorm2 = new double[n];
+    for (int i = 0; i < n; ++i) {
+        xNorm2[i] = std::inner_product(x->data + i * d, x->data + (i + 1) * d, x->data + i * d, 0.0);
+    }
+
+    sumNewCenters = new double *[numThreads];
+    clusterSize = new int *[numThreads];
+    clusterSSE = new double *[numThreads];
+    for (int t = 0; t < numThreads; ++t) {
+        sumNewCenters[t] = NULL;
+        clusterSize[t] = NULL;
+        clusterSSE[t] = NULL;
+    }
+
+    assignment = new unsigned short[n];
+    upper = new double[n];
+    lower = new double[n];
+}
+
+double KSweep::pointCenterDist2(int i, int j) const {
+    double ip = std::inner_product(x->data + i * d, x->data + (i + 1) * d, centers->data + j * d, 0.0);
+    return std::max(0.0, xNorm2[i] - 2.0 * ip + centerNorm2[j]);
+}
+
+void KSweep::prepare_centers() {
+    for (int t = 0; t < numThreads; ++t) {
+        delete [] sumNewCenters[t];
+        delete [] clusterSize[t];
+        delete [] clusterSSE[t];
+        sumNewCenters[t] = new double[k * d];
+        clusterSize[t] = new int[k];
+        clusterSSE[t] = new double[k];
+        std::fill(sumNewCenters[t], sumNewCenters[t] + k * d, 0.0);
+        std::fill(clusterSize[t], clusterSize[t] + k, 0);
+        std::fill(clusterSSE[t], clusterSSE[t] + k, 0.0);
+    }
+
+    delete [] centerNorm2;
+    delete [] centerMovement;
+    delete [] s;
+    centerNorm2 = new double[k];
+    centerMovement = new double[k];
+    s = new double[k];
+
+    for (int j = 0; j < k; ++j) {
+        double const *cj = centers->data + j * d;
+        centerNorm2[j] = std::inner_product(cj, cj + d, cj, 0.0);
+        s[j] = std::numeric_limits<double>::max();
+        for (int j2 = 0; j2 < k; ++j2) {
+            if (j2 != j) {
+                s[j] = std::min(s[j], distance2(cj, centers->data + j2 * d, d));
+            }
+        }
+        s[j] = sqrt(s[j]) / 2.0;
+    }
+}
+
+void KSweep::split_centers(int aK) {
+    // the SSE of each old cluster, which is halved each time it is split
+    std::vector<double> total(k, 0.0), estimate(k, 0.0);
+    for (int j = 0; j < k; ++j) {
+        for (int t = 0; t < numThreads; ++t) {
+            total[j] += clusterSSE[t][j];
+        }
+        estimate[j] = total[j];
+    }
+
+    Dataset *c = new Dataset(aK, d);
+    std::copy(centers->data, centers->data + k * d, c->data);
+
+    for (int p = k; p < aK; ++p) {
+        int j = (int)(std::max_element(estimate.begin(), estimate.end()) - estimate.begin());
+
+        // sample a point of cluster j with probability proportional to its
+        // squared distance from the center
+        int pick = -1, last = -1;
+        double r = total[j] * ((double)rand() / ((double)RAND_MAX + 1.0));
+        for (int i = 0; i < n && pick < 0; ++i) {
+            if (assignment[i] == j) {
+                double w = distance2(x->data + i * d, centers->data + j * d, d);
+                if (w > 0.0) {
+                    last = i;
+                    if (r < w) {
+                        pick = i;
+                    }
+                    r -= w;
+                }
+            }
+        }
+        if (pick < 0) {
+            // rounding, or every cluster has zero SSE
+            pick = (last >= 0) ? last : rand() % n;
+        }
+
+        std::copy(x->data + pick * d, x->data + (pick + 1) * d, c->data + p * d);
+        newCenters.push_back(p);
+        estimate[j] /= 2.0;
+    }
+
+    for (int a = 0; a < k; ++a) {
+        remap.push_back(a);
+        shift.push_back(0.0);
+        for (size_t q = 0; q < newCenters.size(); ++q) {
+            oldNewDist.push_back(sqrt(distance2(centers->data + a * d, c->data + newCenters[q] * d, d)));
+        }
+    }
+
+    delete centers;
+    centers = c;
+}
+
+void KSweep::merge_centers(int aK) {
+    // each old center starts as its own group, with its position and size
+    std::vector<std::vector<double> > position(k);
+    std::vector<double> count(k, 0.0);
+    std::vector<bool> merged(k, false);
+    std::vector<int> groupOf(k), alive(k);
+    for (int a = 0; a < k; ++a) {
+        position[a].assign(centers->data + a * d, centers->data + (a + 1) * d);
+        for (int t = 0; t < numThreads; ++t) {
+            count[a] += clusterSize[t][a];
+        }
+        groupOf[a] = a;
+        alive[a] = a;
+    }
+
+    // merge the closest pair of groups into their weighted mean
+    while ((int)alive.size() > aK) {
+        size_t best1 = 0, best2 = 1;
+        double bestDist2 = std::numeric_limits<double>::max();
+        for (size_t g1 = 0; g1 < alive.size(); ++g1) {
+            for (size_t g2 = g1 + 1; g2 < alive.size(); ++g2) {
+                double dd = distance2(&position[alive[g1]][0], &position[alive[g2]][0], d);
+                if (dd < bestDist2) {
+                    bestDist2 = dd;
+                    best1 = g1;
+                    best2 = g2;
+                }
+            }
+        }
+
+        int into = alive[best1], from = alive[best2];
+        double w1 = count[into], w2 = count[from];
+        if (w1 + w2 <= 0.0) {
+            w1 = w2 = 1.0;
+        }
+        for (int dim = 0; dim < d; ++dim) {
+            position[into][dim] = (w1 * position[into][dim] + w2 * position[from][dim]) / (w1 + w2);
+        }
+        count[into] += count[from];
+        merged[into] = true;
+        for (int a = 0; a < k; ++a) {
+            if (groupOf[a] == from) {
+                groupOf[a] = into;
+            }
+        }
+        alive.erase(alive.begin() + best2);
+    }
+
+    // the surviving groups become the new centers, in order
+    Dataset *c = new Dataset(aK, d);
+    std::vector<int> newIndex(k, -1);
+    for (size_t g = 0; g < alive.size(); ++g) {
+        newIndex[alive[g]] = (int)g;
+        std::copy(position[alive[g]].begin(), position[alive[g]].end(), c->data + g * d);
+        if (merged[alive[g]]) {
+            newCenters.push_back((int)g);
+        }
+    }
+
+    for (int a = 0; a < k; ++a) {
+        remap.push_back(newIndex[groupOf[a]]);
+        shift.push_back(sqrt(distance2(centers->data + a * d, c->data + remap[a] * d, d)));
+        for (size_t q = 0; q < newCenters.size(); ++q) {
+            oldNewDist.push_back(sqrt(distance2(centers->data + a * d, c->data + newCenters[q] * d, d)));
+        }
+    }
+
+    delete centers;
+    centers = c;
+}
+
+#ifdef USE_THREADS
+struct KSweepThreadInfo {
+    KSweep *km;
+    int threadId, maxIterations, numIterations;
+    pthread_t pthread_id;
+};
+#endif
+
+void *KSweep::runner(void *args) {
+    #ifdef USE_THREADS
+    KSweepThreadInfo *ti = (KSweepThreadInfo *)args;
+    ti->numIterations = ti->km->runThread(ti->threadId, ti->maxIterations);
+    #endif
+    return NULL;
+}
+
+int KSweep::run(unsigned short aK, int maxIterations) {
+    remap.clear();
+    shift.clear();
+    newCenters.clear();
+    oldNewDist.clear();
+
+    aK = std::min((int)aK, n);
+    oldK = k;
+    if (k == 0) {
+        centers = init_centers_kmeanspp_v2(*x, aK);
+        std::fill(assignment, assignment + n, 0);
+        std::fill(upper, upper + n, std::numeric_limits<double>::max());
+        std::fill(lower, lower + n, 0.0);
+    } else if (aK >= k) {
+        split_centers(aK);
+    } else {
+        merge_centers(aK);
+    }
+    k = aK;
+    prepare_centers();
+    converged = false;
+
+    int iterations = 0;
+    #ifdef USE_THREADS
+    {
+        pthread_barrier_init(&barrier, NULL, numThreads);
+        KSweepThreadInfo *info = new KSweepThreadInfo[numThreads];
+        for (int t = 0; t < numThreads; ++t) {
+            info[t].km = this;
+            info[t].threadId = t;
+            info[t].maxIterations = maxIterations;
+            pthread_create(&info[t].pthread_id, NULL, KSweep::runner, &info[t]);
+        }
+        for (int t = 0; t < numThreads; ++t) {
+            pthread_join(info[t].pthread_id, NULL);
+        }
+        iterations = info[0].numIterations;
+        delete [] info;
+        pthread_barrier_destroy(&barrier);
+    }
+    #else
+    {
+        iterations = runThread(0, maxIterations);
+    }
+    #endif
+
+    sse = 0.0;
+    for (int j = 0; j < k; ++j) {
+        for (int t = 0; t < numThreads; ++t) {
+            sse += clusterSSE[t][j];
+        }
+    }
+
+    return iterations;
+}
+
+std::vector<double> KSweep::sweep(std::vector<int> const &kValues, int maxIterations) {
+    std::vector<double> curve;
+    for (size_t v = 0; v < kValues.size(); ++v) {
+        run(kValues[v], maxIterations);
+        curve.push_back(sse);
+    }
+    return curve;
+}
+
+/* After carrying over the previous solution, each iteration assigns the
+ * points with Hamerly's tests; then thread 0 moves the centers, and all
+ * threads update their points' bounds. A final pass tightens the upper bounds
+ * to the exact distances and measures the SSE of each cluster (which guides
+ * the next split).
+ *
+ * Parameters:
+ *   - threadId: the index of the thread that is running
+ *   - maxIterations: a bound on the number of iterations to perform
+ *
+ * Return value: the number of iterations performed
+ */
+int KSweep::runThread(int threadId, int maxIterations) {
+    int iterations = 0;
+
+    int startNdx = (int)((long long)n * threadId / numThreads);
+    int endNdx = (int)((long long)n * (threadId + 1) / numThreads);
+
+    carry_over(threadId, startNdx, endNdx);
+    synchronizeAllThreads();
+
+    while ((iterations < maxIterations) && ! converged) {
+        ++iterations;
+
+        assign_points(threadId, startNdx, endNdx);
+        synchronizeAllThreads();
+
+        if (threadId == 0) {
+            converged = ! move_centers();
+        }
+        synchronizeAllThreads();
+
+        if (! converged) {
+            update_bounds(startNdx, endNdx);
+        }
+        synchronizeAllThreads();
+    }
+
+    for (int i = startNdx; i < endNdx; ++i) {
+        double d2 = distance2(x->data + i * d, centers->data + assignment[i] * d, d);
+        upper[i] = sqrt(d2);
+        clusterSSE[threadId][assignment[i]] += d2;
+    }
+
+    return iterations;
+}
+
+void KSweep::carry_over(int threadId, int startNdx, int endNdx) {
+    size_t numNew = newCenters.size();
+    for (int i = startNdx; i < endNdx; ++i) {
+        if (oldK > 0) {
+            int a = assignment[i];
+            double oldUpper = upper[i];
+            upper[i] = oldUpper + shift[a];
+            assignment[i] = remap[a];
+            // d(x, c) >= d(old center, c) - d(x, old center)
+            for (size_t q = 0; q < numNew; ++q) {
+                if (newCenters[q] != remap[a]) {
+                    lower[i] = std::min(lower[i], oldNewDist[a * numNew + q] - oldUpper);
+                }
+            }
+        }
+
+        ++clusterSize[threadId][assignment[i]];
+        addVectors(sumNewCenters[threadId] + assignment[i] * d, x->data + i * d, d);
+    }
+}
+
+void KSweep::assign_points(int threadId, int startNdx, int endNdx) {
+    for (int i = startNdx; i < endNdx; ++i) {
+        unsigned short closest = assignment[i];
+
+        // Hamerly's tests, as in HamerlyKmeans
+        double bound = std::max(s[closest], lower[i]);
+        if (upper[i] <= bound) {
+            continue;
+        }
+        upper[i] = sqrt(pointCenterDist2(i, closest));
+        if (upper[i] <= bound) {
+            continue;
+        }
+
+        // look at all centers, taking the lowest index on ties
+        double closestDist2 = std::numeric_limits<double>::max();
+        double secondDist2 = std::numeric_limits<double>::max();
+        for (int j = 0; j < k; ++j) {
+            double d2 = pointCenterDist2(i, j);
+            if (d2 < closestDist2) {
+                secondDist2 = closestDist2;
+                closestDist2 = d2;
+                closest = j;
+            } else if (d2 < secondDist2) {
+                secondDist2 = d2;
+            }
+        }
+
+        upper[i] = sqrt(closestDist2);
+        lower[i] = sqrt(secondDist2);
+
+        if (assignment[i] != closest) {
+            double const *xp = x->data + i * d;
+            --clusterSize[threadId][assignment[i]];
+            subVectors(sumNewCenters[threadId] + assignment[i] * d, xp, d);
+            ++clusterSize[threadId][closest];
+            addVectors(sumNewCenters[threadId] + closest * d, xp, d);
+            assignment[i] = closest;
+        }
+    }
+}
+
+bool KSweep::move_centers() {
+    bool moved = false;
+    for (int j = 0; j < k; ++j) {
+        centerMovement[j] = 0.0;
+        int totalClusterSize = 0;
+        for (int t = 0; t < numThreads; ++t) {
+            totalClusterSize += clusterSize[t][j];
+        }
+        if (totalClusterSize > 0) {
+            for (int dim = 0; dim < d; ++dim) {
+                double z = 0.0;
+                for (int t = 0; t < numThreads; ++t) {
+                    z += sumNewCenters[t][j * d + dim];
+                }
+                z /= totalClusterSize;
+                centerMovement[j] += (z - (*centers)(j, dim)) * (z - (*centers)(j, dim));
+                (*centers)(j, dim) = z;
+            }
+        }
+        centerMovement[j] = sqrt(centerMovement[j]);
+        moved = moved || (centerMovement[j] > 0.0);
+    }
+
+    for (int c1 = 0; c1 < k; ++c1) {
+        double const *cp = centers->data + c1 * d;
+        centerNorm2[c1] = std::inner_product(cp, cp + d, cp, 0.0);
+        s[c1] = std::numeric_limits<double>::max();
+        for (int c2 = 0; c2 < k; ++c2) {
+            if (c2 != c1) {
+                s[c1] = std::min(s[c1], distance2(cp, centers->data + c2 * d, d));
+            }
+        }
+        s[c1] = sqrt(s[c1]) / 2.0;
+    }
+
+    // the lower bound shrinks by the furthest movement of any center other
+    // than the assigned one
+    furthest = (int)(std::max_element(centerMovement, centerMovement + k) - centerMovement);
+    secondFurthest = 0.0;
+    for (int j = 0; j < k; ++j) {
+        if (j != furthest) {
+            secondFurthest = std::max(secondFurthest, centerMovement[j]);
+        }
+    }
+
+    return moved;
+}
+
+void KSweep::update_bounds(int startNdx, int endNdx) {
+    for (int i = startNdx; i < endNdx; ++i) {
+        unsigned short a = assignment[i];
+        upper[i] += centerMovement[a];
+        lower[i] -= (a == furthest) ? secondFurthest : centerMovement[furthest];
+    }
+}
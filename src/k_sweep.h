@@ -0,0 +1,147 @@
+#ifndef K_SWEEP_H
+#define K_SWEEP_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * KSweep clusters one dataset with a sequence of values of k (e.g. for model
+ * selection by the elbow of the objective curve), warm-starting each k from
+ * the solution for the previous one instead of starting cold:
+ *  - the squared norms of the points are computed once, and distances are
+ *    computed from inner products;
+ *  - when k grows, the previous clusters with the largest SSE are split, by
+ *    adding a center sampled (by D^2) from among their points; when k shrinks,
+ *    the closest pairs of centers are merged (into their weighted mean);
+ *  - each point keeps its assignment and Hamerly's bounds across k. A center
+ *    that did not change keeps its points' bounds; a point whose center was
+ *    merged moves its upper bound by how far the center moved, and lower
+ *    bounds are lowered using the distances from the old centers to the new
+ *    ones (by the triangle inequality).
+ * Each k is then run to convergence with Hamerly's algorithm.
+ */
+
+#include "dataset.h"
+#include <limits>
+#include <string>
+#include <vector>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
+
+class KSweep {
+    public:
+        KSweep();
+        ~KSweep() { free(); }
+
+        // Prepare to cluster x (which must outlive this object).
+        void initialize(Dataset const *aX, int aNumThreads);
+        void free();
+
+        // Cluster with aK centers (at most n), and return the number of
+        // iterations performed. The first call seeds the centers with
+        // k-means++; later calls start from the previous solution.
+        int run(unsigned short aK, int maxIterations = std::numeric_limits<int>::max());
+
+        // Run each of the given values of k in turn, and return the objective
+        // curve (the SSE for each k).
+        std::vector<double> sweep(std::vector<int> const &kValues, int maxIterations = std::numeric_limits<int>::max());
+
+        // The SSE of the last run, and its centers and assignment.
+        double getSSE() const { return sse; }
+        Dataset const *getCenters() const { return centers; }
+        int getAssignment(int xIndex) const { return assignment[xIndex]; }
+        int getK() const { return k; }
+
+        std::string getName() const { return "ksweep"; }
+
+    private:
+        // Change the centers from the previous solution to aK centers, and
+        // record how to carry over the bounds (done before the threads start).
+        void split_centers(int aK);
+        void merge_centers(int aK);
+
+        // Allocate the per-center arrays for the current k, and compute the
+        // center norms and s.
+        void prepare_centers();
+
+        // This is where each thread does its work.
+        int runThread(int threadId, int maxIterations);
+        static void *runner(void *args);
+
+        // Carry over the assignment and bounds of points [startNdx, endNdx) to
+        // the new centers, and recompute this thread's sufficient statistics.
+        void carry_over(int threadId, int startNdx, int endNdx);
+
+        // Assign points [startNdx, endNdx) with Hamerly's tests.
+        void assign_points(int threadId, int startNdx, int endNdx);
+
+        // Move the centers to the means of their points; compute how far they
+        // moved, their norms, and s. Returns whether any center moved.
+        bool move_centers();
+
+        void update_bounds(int startNdx, int endNdx);
+
+        // Squared distance from point i to center j, from inner products.
+        double pointCenterDist2(int i, int j) const;
+
+        void synchronizeAllThreads() {
+            #ifdef USE_THREADS
+            pthread_barrier_wait(&barrier);
+            #endif
+        }
+
+        Dataset const *x;
+        int n, d, numThreads;
+
+        // The current number of centers, and the number before this run (0 if
+        // this is the first run).
+        int k, oldK;
+
+        // The squared norm of each point, computed once.
+        double *xNorm2;
+
+        // The centers, their squared norms, how far they moved in the last
+        // iteration, half the distance to the closest other center, and the
+        // furthest and second-furthest movement.
+        Dataset *centers;
+        double *centerNorm2;
+        double *centerMovement;
+        double *s;
+        int furthest;
+        double secondFurthest;
+
+        // For each thread, the sum and count of the points assigned to each
+        // center, and the SSE of each cluster.
+        double **sumNewCenters;
+        int **clusterSize;
+        double **clusterSSE;
+
+        // Each point's assignment and Hamerly's bounds.
+        unsigned short *assignment;
+        double *upper, *lower;
+
+        // How to carry over from the old centers (indexed by old center a):
+        // the new index of each old center, and the distance between its old
+        // and new positions; the indexes of the new centers (those added or
+        // merged); and the distance from each old center to each new center
+        // (indexed by a * newCenters.size() + q).
+        std::vector<int> remap;
+        std::vector<double> shift;
+        std::vector<int> newCenters;
+        std::vector<double> oldNewDist;
+
+        bool converged;
+        double sse;
+
+        #ifdef USE_THREADS
+        pthread_barrier_t barrier;
+        #endif
+
+        // Disallow copies.
+        KSweep(KSweep const &);
+        KSweep const &operator=(KSweep const &);
+};
+
+#endif
@@ -0,0 +1,178 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "kd_tree.h"
+#include "general_functions.h"
+#include <algorithm>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
+
+// Orders record indexes by their value in one dimension; used to find the
+// median record when splitting a node.
+class CompareDimension {
+    public:
+        CompareDimension(Dataset const *aX, int aDim) : x(aX), dim(aDim) {}
+        bool operator()(int a, int b) const { return (*x)(a, dim) < (*x)(b, dim); }
+    private:
+        Dataset const *x;
+        int dim;
+};
+
+#ifdef USE_THREADS
+struct BuildInfo {
+    KdTree *tree;
+    int node, startNdx, endNdx, numThreads;
+};
+#endif
+
+KdTree::KdTree(Dataset const *aX, int numThreads, int aLeafSize) : x(aX), leafSize(aLeafSize) {
+    int n = x->n, d = x->d;
+    if (leafSize < 1) {
+        leafSize = 1;
+    }
+
+    // the shape of the tree is determined by n alone, so all storage can be
+    // allocated before building
+    numNodes = subtreeSize(n);
+    depth = subtreeDepth(n);
+
+    index = new int[n];
+    nodeStart = new int[numNodes];
+    nodeEnd = new int[numNodes];
+    nodeRight = new int[numNodes];
+    lower = new double[numNodes * d];
+    upper = new double[numNodes * d];
+    sum = new double[numNodes * d];
+
+    for (int i = 0; i < n; ++i) {
+        index[i] = i;
+    }
+
+    build(0, 0, n, numThreads);
+}
+
+KdTree::~KdTree() {
+    delete [] index;
+    delete [] nodeStart;
+    delete [] nodeEnd;
+    delete [] nodeRight;
+    delete [] lower;
+    delete [] upper;
+    delete [] sum;
+}
+
+int KdTree::subtreeSize(int numRecords) {
+    if (numRecords <= leafSize) {
+        return 1;
+    }
+    std::map<int, int>::const_iterator found = sizeMemo.find(numRecords);
+    if (found != sizeMemo.end()) {
+        return found->second;
+    }
+    int half = numRecords / 2;
+    int size = 1 + subtreeSize(half) + subtreeSize(numRecords - half);
+    sizeMemo[numRecords] = size;
+    return size;
+}
+
+int KdTree::subtreeDepth(int numRecords) {
+    if (numRecords <= leafSize) {
+        return 0;
+    }
+    std::map<int, int>::const_iterator found = depthMemo.find(numRecords);
+    if (found != depthMemo.end()) {
+        return found->second;
+    }
+    // the right half is never smaller than the left half
+    int result = 1 + subtreeDepth(numRecords - numRecords / 2);
+    depthMemo[numRecords] = result;
+    return result;
+}
+
+void *KdTree::builder(void *args) {
+    #ifdef USE_THREADS
+    BuildInfo *bi = (BuildInfo *)args;
+    bi->tree->build(bi->node, bi->startNdx, bi->endNdx, bi->numThreads);
+    #endif
+    return NULL;
+}
+
+/* Build the subtree rooted at the given node. The node's bounding box is
+ * computed directly from its records; its sum is computed from its children
+ * (or directly, for leaves). The left subtree is handed to a new thread while
+ * there are threads to spare.
+ *
+ * Parameters:
+ *  node -- the index of the node to build
+ *  startNdx, endNdx -- the range of index[] owned by this node
+ *  numThreads -- the number of threads available to build this subtree
+ *
+ * Return value: none
+ */
+void KdTree::build(int node, int startNdx, int endNdx, int numThreads) {
+    int d = x->d;
+    double *lo = lower + node * d, *hi = upper + node * d, *s = sum + node * d;
+
+    nodeStart[node] = startNdx;
+    nodeEnd[node] = endNdx;
+    nodeRight[node] = -1;
+
+    std::copy(x->data + index[startNdx] * d, x->data + (index[startNdx] + 1) * d, lo);
+    std::copy(lo, lo + d, hi);
+    for (int p = startNdx + 1; p < endNdx; ++p) {
+        double const *xp = x->data + index[p] * d;
+        for (int dim = 0; dim < d; ++dim) {
+            if (xp[dim] < lo[dim]) { lo[dim] = xp[dim]; }
+            if (hi[dim] < xp[dim]) { hi[dim] = xp[dim]; }
+        }
+    }
+
+    if (isLeaf(node)) {
+        std::fill(s, s + d, 0.0);
+        for (int p = startNdx; p < endNdx; ++p) {
+            addVectors(s, x->data + index[p] * d, d);
+        }
+        return;
+    }
+
+    // split at the median of the widest dimension
+    int splitDim = 0;
+    for (int dim = 1; dim < d; ++dim) {
+        if (hi[splitDim] - lo[splitDim] < hi[dim] - lo[dim]) {
+            splitDim = dim;
+        }
+    }
+    int midNdx = startNdx + (endNdx - startNdx) / 2;
+    std::nth_element(index + startNdx, index + midNdx, index + endNdx, CompareDimension(x, splitDim));
+
+    int leftChild = left(node);
+    int leftSize = midNdx - startNdx;
+    int rightChild = leftChild + (leftSize <= leafSize ? 1 : sizeMemo.find(leftSize)->second);
+    nodeRight[node] = rightChild;
+
+    #ifdef USE_THREADS
+    if (numThreads > 1) {
+        BuildInfo info;
+        info.tree = this;
+        info.node = leftChild;
+        info.startNdx = startNdx;
+        info.endNdx = midNdx;
+        info.numThreads = numThreads / 2;
+        pthread_t leftThread;
+        pthread_create(&leftThread, NULL, KdTree::builder, &info);
+        build(rightChild, midNdx, endNdx, numThreads - numThreads / 2);
+        pthread_join(leftThread, NULL);
+    } else
+    #endif
+    {
+        build(leftChild, startNdx, midNdx, 1);
+        build(rightChild, midNdx, endNdx, 1);
+    }
+
+    std::copy(sum + leftChild * d, sum + (leftChild + 1) * d, s);
+    addVectors(s, sum + rightChild * d, d);
+}
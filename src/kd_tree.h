@@ -0,0 +1,81 @@
+#ifndef KD_TREE_H
+#define KD_TREE_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * KdTree is a static kd-tree over the records of a Dataset. Each node owns a
+ * contiguous range of a permutation of the record indexes, and caches the
+ * tight bounding box and the sum of the records in that range. Nodes are split
+ * at the median of their widest dimension, so the shape of the tree depends
+ * only on n and the leaf size; this lets the tree be built in parallel into
+ * preallocated storage.
+ */
+
+#include "dataset.h"
+#include <map>
+
+class KdTree {
+    public:
+        // Build a kd-tree over the records of aX, using up to numThreads
+        // threads. Nodes with at most aLeafSize records are leaves.
+        KdTree(Dataset const *aX, int numThreads = 1, int aLeafSize = 8);
+        ~KdTree();
+
+        // Whether the given node is a leaf.
+        bool isLeaf(int node) const { return nodeEnd[node] - nodeStart[node] <= leafSize; }
+
+        // The children of an internal node. The left child is always stored
+        // directly after its parent.
+        int left(int node) const { return node + 1; }
+        int right(int node) const { return nodeRight[node]; }
+
+        // The number of records under the given node.
+        int count(int node) const { return nodeEnd[node] - nodeStart[node]; }
+
+        // The dataset this tree was built over.
+        Dataset const *x;
+
+        // The maximum number of records in a leaf, the number of nodes, and
+        // the depth of the deepest node (the root has depth 0).
+        int leafSize, numNodes, depth;
+
+        // A permutation of [0, n); node j owns the record indexes
+        // index[nodeStart[j]] ... index[nodeEnd[j] - 1].
+        int *index;
+        int *nodeStart, *nodeEnd;
+
+        // The index of the right child of each internal node (-1 for leaves).
+        int *nodeRight;
+
+        // The tight bounding box of each node's records (numNodes * d each).
+        double *lower, *upper;
+
+        // The sum of each node's records (numNodes * d).
+        double *sum;
+
+    private:
+        // Build the subtree rooted at node, over the index range [startNdx,
+        // endNdx), using up to numThreads threads.
+        void build(int node, int startNdx, int endNdx, int numThreads);
+
+        // Static entry method for pthread_create().
+        static void *builder(void *args);
+
+        // The number of nodes in (and depth of) a subtree with the given
+        // number of records.
+        int subtreeSize(int numRecords);
+        int subtreeDepth(int numRecords);
+
+        // Memoized results of subtreeSize() and subtreeDepth(); at every level
+        // of the tree there are at most two distinct subtree sizes.
+        std::map<int, int> sizeMemo, depthMemo;
+
+        // Disallow copies.
+        KdTree(KdTree const &);
+        KdTree const &operator=(KdTree const &);
+};
+
+#endif
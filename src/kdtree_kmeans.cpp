@@ -0,0 +1,226 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "kdtree_kmeans.h"
+#include "general_functions.h"
+#include <algorithm>
+#include <limits>
+
+void KdTreeKmeans::free() {
+    for (int t = 0; t < numThreads; ++t) {
+        delete [] candidates[t];
+    }
+    OriginalSpaceKmeans::free();
+    delete [] candidates;
+    delete [] owner;
+    delete ownedTree;
+    candidates = NULL;
+    owner = NULL;
+    if (tree == ownedTree) {
+        tree = NULL;
+    }
+    ownedTree = NULL;
+    frontier.clear();
+}
+
+void KdTreeKmeans::initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads) {
+    OriginalSpaceKmeans::initialize(aX, aK, initialAssignment, aNumThreads);
+
+    if (tree == NULL || tree->x != x) {
+        tree = ownedTree = new KdTree(x, numThreads);
+    }
+
+    owner = new unsigned short[tree->numNodes];
+    std::fill(owner, owner + tree->numNodes, k);
+
+    candidates = new unsigned short *[numThreads];
+    for (int t = 0; t < numThreads; ++t) {
+        candidates[t] = new unsigned short[(tree->depth + 1) * k];
+    }
+
+    // Split the top of the tree until there are a few nodes per thread to
+    // balance the work. The nodes above the frontier are never assigned as a
+    // whole, which costs little.
+    size_t frontierSize = (numThreads == 1) ? 1 : 4 * numThreads;
+    frontier.assign(1, 0);
+    bool split = true;
+    while (frontier.size() < frontierSize && split) {
+        std::vector<int> next;
+        split = false;
+        for (size_t f = 0; f < frontier.size(); ++f) {
+            if (tree->isLeaf(frontier[f])) {
+                next.push_back(frontier[f]);
+            } else {
+                next.push_back(tree->left(frontier[f]));
+                next.push_back(tree->right(frontier[f]));
+                split = true;
+            }
+        }
+        frontier.swap(next);
+    }
+}
+
+/* Each iteration rebuilds the sufficient statistics (clusterSize and
+ * sumNewCenters) from scratch by traversing the tree, since whole subtrees are
+ * added at once using their cached sums.
+ *
+ * Parameters:
+ *   - threadId: the index of the thread that is running
+ *   - maxIterations: a bound on the number of iterations to perform
+ *
+ * Return value: the number of iterations performed (always at least 1)
+ */
+int KdTreeKmeans::runThread(int threadId, int maxIterations) {
+    int iterations = 0;
+
+    while ((iterations < maxIterations) && ! converged) {
+        ++iterations;
+
+        std::fill(clusterSize[threadId], clusterSize[threadId] + k, 0);
+        sumNewCenters[threadId]->fill(0.0);
+
+        for (size_t f = threadId; f < frontier.size(); f += numThreads) {
+            for (int j = 0; j < k; ++j) {
+                candidates[threadId][j] = j;
+            }
+            filter(frontier[f], 0, k, threadId);
+        }
+
+        // records are assigned in tree order, so wait for all threads before
+        // verifying this thread's range of records
+        synchronizeAllThreads();
+        verifyAssignment(iterations, start(threadId), end(threadId));
+
+        synchronizeAllThreads();
+        if (threadId == 0) {
+            int furthestMovingCenter = move_centers();
+            converged = (0.0 == centerMovement[furthestMovingCenter]);
+        }
+
+        synchronizeAllThreads();
+    }
+
+    return iterations;
+}
+
+/* Filter the candidates for the given node. The candidate closest to the
+ * midpoint of the node's bounding box (z*) is kept; every other candidate z is
+ * discarded if it is no closer than z* to every point in the box. That is
+ * checked at the vertex of the box furthest in the direction of (z - z*),
+ * where d(., z)^2 - d(., z*)^2 is smallest. Ties are broken toward the lower
+ * center index, as in Lloyd's algorithm.
+ *
+ * Parameters:
+ *  node -- the root of the subtree to assign
+ *  level -- which of this thread's candidate lists holds the candidates,
+ *      which are sorted by center index
+ *  numCandidates -- how many candidates there are
+ *  threadId -- the thread doing the work
+ *
+ * Return value: none
+ */
+void KdTreeKmeans::filter(int node, int level, int numCandidates, int threadId) {
+    unsigned short const *cand = candidates[threadId] + level * k;
+
+    if (tree->isLeaf(node)) {
+        unsigned short uniform = k;
+        for (int p = tree->nodeStart[node]; p < tree->nodeEnd[node]; ++p) {
+            int i = tree->index[p];
+            unsigned short closest = cand[0];
+            double closestDist2 = pointCenterDist2(i, closest);
+            for (int c = 1; c < numCandidates; ++c) {
+                double d2 = pointCenterDist2(i, cand[c]);
+                if (d2 < closestDist2) {
+                    closest = cand[c];
+                    closestDist2 = d2;
+                }
+            }
+            assignment[i] = closest;
+            ++clusterSize[threadId][closest];
+            addVectors(sumNewCenters[threadId]->data + closest * d, x->data + i * d, d);
+
+            if (p == tree->nodeStart[node]) {
+                uniform = closest;
+            } else if (uniform != closest) {
+                uniform = k;
+            }
+        }
+        owner[node] = uniform;
+        return;
+    }
+
+    double const *lo = tree->lower + node * d;
+    double const *hi = tree->upper + node * d;
+
+    // find the candidate closest to the midpoint of the bounding box
+    unsigned short zStar = cand[0];
+    double zStarDist2 = std::numeric_limits<double>::max();
+    for (int c = 0; c < numCandidates; ++c) {
+        double const *z = centers->data + cand[c] * d;
+        double d2 = 0.0;
+        for (int dim = 0; dim < d; ++dim) {
+            double diff = (lo[dim] + hi[dim]) / 2.0 - z[dim];
+            d2 += diff * diff;
+        }
+        if (d2 < zStarDist2) {
+            zStarDist2 = d2;
+            zStar = cand[c];
+        }
+    }
+
+    // keep the candidates that might be closest for some point in the box
+    unsigned short *next = candidates[threadId] + (level + 1) * k;
+    int numNext = 0;
+    double const *zs = centers->data + zStar * d;
+    for (int c = 0; c < numCandidates; ++c) {
+        if (cand[c] == zStar) {
+            next[numNext++] = zStar;
+            continue;
+        }
+        double const *z = centers->data + cand[c] * d;
+        double zDist2 = 0.0, zStarVertexDist2 = 0.0;
+        for (int dim = 0; dim < d; ++dim) {
+            double v = (zs[dim] < z[dim]) ? hi[dim] : lo[dim];
+            zDist2 += (v - z[dim]) * (v - z[dim]);
+            zStarVertexDist2 += (v - zs[dim]) * (v - zs[dim]);
+        }
+        if ((zDist2 < zStarVertexDist2) || ((zDist2 == zStarVertexDist2) && (cand[c] < zStar))) {
+            next[numNext++] = cand[c];
+        }
+    }
+
+    #ifdef COUNT_DISTANCES
+    numDistances += numCandidates + 2 * (numCandidates - 1);
+    #endif
+
+    if (numNext == 1) {
+        assignSubtree(node, zStar, threadId);
+        return;
+    }
+
+    // the children are about to be assigned separately, so push down what we
+    // know about this subtree
+    if (owner[node] != k) {
+        owner[tree->left(node)] = owner[tree->right(node)] = owner[node];
+        owner[node] = k;
+    }
+
+    filter(tree->left(node), level + 1, numNext, threadId);
+    filter(tree->right(node), level + 1, numNext, threadId);
+}
+
+void KdTreeKmeans::assignSubtree(int node, unsigned short j, int threadId) {
+    clusterSize[threadId][j] += tree->count(node);
+    addVectors(sumNewCenters[threadId]->data + j * d, tree->sum + node * d, d);
+
+    // only touch the records if they are not already all assigned to j
+    if (owner[node] != j) {
+        for (int p = tree->nodeStart[node]; p < tree->nodeEnd[node]; ++p) {
+            assignment[tree->index[p]] = j;
+        }
+        owner[node] = j;
+    }
+}
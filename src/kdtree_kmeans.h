@@ -0,0 +1,70 @@
+#ifndef KDTREE_KMEANS_H
+#define KDTREE_KMEANS_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * KdTreeKmeans implements the filtering algorithm of Kanungo et al. (also
+ * described by Pelleg and Moore). A kd-tree over the data is built once; each
+ * iteration the set of candidate centers is filtered as the tree is descended,
+ * and whenever a single candidate remains for a node, the whole subtree is
+ * assigned to it at once using the node's cached sum and count. This is very
+ * effective in low dimension (roughly d <= 8), and degrades to Lloyd's
+ * algorithm (plus overhead) in high dimension.
+ *
+ * Since the new centers are summed from whole subtrees (divided among the
+ * threads), they match Lloyd's only up to rounding, which depends on the
+ * number of threads; the assignments and iterations are the same.
+ */
+
+#include "original_space_kmeans.h"
+#include "kd_tree.h"
+#include <vector>
+
+class KdTreeKmeans : public OriginalSpaceKmeans {
+    public:
+        // Cluster using the given tree, which must have been built over the
+        // same dataset passed to initialize(). If aTree is NULL (or was built
+        // over a different dataset), a tree is built in initialize().
+        KdTreeKmeans(KdTree const *aTree = NULL) : tree(aTree), ownedTree(NULL), owner(NULL), candidates(NULL) {}
+        virtual ~KdTreeKmeans() { free(); }
+        virtual void free();
+        using Kmeans::initialize;
+        virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
+        virtual std::string getName() const { return "kdtree"; }
+
+    protected:
+        virtual int runThread(int threadId, int maxIterations);
+
+        // Filter the candidate centers for the subtree rooted at node, and
+        // assign that subtree's records. The candidates are stored in this
+        // thread's buffer at the given level.
+        void filter(int node, int level, int numCandidates, int threadId);
+
+        // Assign all records under node to center j, adding the node's cached
+        // statistics to this thread's sufficient statistics.
+        void assignSubtree(int node, unsigned short j, int threadId);
+
+        // The tree used for clustering, and the tree we built ourselves (if
+        // any), which must be deleted.
+        KdTree const *tree;
+        KdTree *ownedTree;
+
+        // For each node, the center that every record in its subtree is
+        // currently assigned to, or k if this is not known. A node's owner is
+        // only valid if none of its ancestors has a valid owner; owners are
+        // pushed down to the children as the tree is descended.
+        unsigned short *owner;
+
+        // The nodes at which the threads begin their traversals; thread t
+        // handles the nodes at positions t, t + numThreads, ...
+        std::vector<int> frontier;
+
+        // For each thread, one list of candidate centers per tree level
+        // (depth + 1 lists of k candidates).
+        unsigned short **candidates;
+};
+
+#endif
@@ -0,0 +1,209 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "kernel_cache.h"
+#include "kernel_kmeans.h"
+#include <algorithm>
+
+// The number of records in each block of the full matrix computation.
+static const int KERNEL_CACHE_BLOCK = 64;
+
+// The number of rows in each set of the row cache.
+static const int KERNEL_CACHE_WAYS = 4;
+
+struct KernelCacheThreadInfo {
+    Kernel const *kernel;
+    Dataset const *x;
+    double const *norms2;
+    double *matrix;
+    int threadId, numThreads;
+    #ifdef USE_THREADS
+    pthread_t pthread_id;
+    #endif
+};
+
+// Compute the blocks on and above the diagonal of the matrix that belong to
+// this thread (every numThreads-th one), filling in the transposed block too.
+static void *kernel_cache_runner(void *args) {
+    KernelCacheThreadInfo *ti = (KernelCacheThreadInfo *)args;
+    Dataset const &x = *ti->x;
+    int n = x.n, d = x.d;
+    int numBlocks = (n + KERNEL_CACHE_BLOCK - 1) / KERNEL_CACHE_BLOCK;
+
+    long long blockNdx = 0;
+    for (int b1 = 0; b1 < numBlocks; ++b1) {
+        for (int b2 = b1; b2 < numBlocks; ++b2, ++blockNdx) {
+            if (blockNdx % ti->numThreads != ti->threadId) {
+                continue;
+            }
+            int end1 = std::min(n, (b1 + 1) * KERNEL_CACHE_BLOCK);
+            int end2 = std::min(n, (b2 + 1) * KERNEL_CACHE_BLOCK);
+            for (int i = b1 * KERNEL_CACHE_BLOCK; i < end1; ++i) {
+                double *row = ti->matrix + (size_t)i * n;
+                int start2 = (b1 == b2) ? i : b2 * KERNEL_CACHE_BLOCK;
+                ti->kernel->evaluate(x.data + i * d, ti->norms2[i], x, ti->norms2, NULL, start2, end2 - start2, row + start2);
+            }
+            // mirror the block below the diagonal
+            for (int j = b2 * KERNEL_CACHE_BLOCK; j < end2; ++j) {
+                double *row = ti->matrix + (size_t)j * n;
+                int end = (b1 == b2) ? j : end1;
+                for (int i = b1 * KERNEL_CACHE_BLOCK; i < end; ++i) {
+                    row[i] = ti->matrix[(size_t)i * n + j];
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+KernelCache::KernelCache(Kernel const &aKernel, Dataset const *aX, double const *aNorms2, size_t maxBytes, int numThreads) :
+    kernel(aKernel), x(aX), norms2(aNorms2), n(aX->n), matrix(NULL), numSets(0), numWays(0),
+    rows(NULL), tags(NULL), stamps(NULL), clocks(NULL), requested(NULL) {
+    #ifdef USE_THREADS
+    setLocks = NULL;
+    #endif
+
+    size_t rowBytes = (size_t)n * sizeof(double);
+    size_t maxRows = maxBytes / rowBytes;
+
+    if (maxRows >= (size_t)n) {
+        matrix = new double[(size_t)n * n];
+
+        #ifdef USE_THREADS
+        int threads = std::max(1, numThreads);
+        #else
+        int threads = 1;
+        #endif
+        KernelCacheThreadInfo *info = new KernelCacheThreadInfo[threads];
+        for (int t = 0; t < threads; ++t) {
+            info[t].kernel = &kernel;
+            info[t].x = x;
+            info[t].norms2 = norms2;
+            info[t].matrix = matrix;
+            info[t].threadId = t;
+            info[t].numThreads = threads;
+        }
+
+        #ifdef USE_THREADS
+        for (int t = 0; t < threads; ++t) {
+            pthread_create(&info[t].pthread_id, NULL, kernel_cache_runner, &info[t]);
+        }
+        for (int t = 0; t < threads; ++t) {
+            pthread_join(info[t].pthread_id, NULL);
+        }
+        #else
+        kernel_cache_runner(&info[0]);
+        #endif
+
+        delete [] info;
+        return;
+    }
+
+    // hold as many rows as fit (at least one)
+    numWays = (int)std::max((size_t)1, std::min((size_t)KERNEL_CACHE_WAYS, maxRows));
+    numSets = (int)std::max((size_t)1, maxRows / numWays);
+    int numRows = numSets * numWays;
+    rows = new double[(size_t)numRows * n];
+    tags = new int[numRows];
+    stamps = new long long[numRows];
+    clocks = new long long[numSets];
+    std::fill(tags, tags + numRows, -1);
+    std::fill(stamps, stamps + numRows, 0);
+    std::fill(clocks, clocks + numSets, 0);
+    requested = new char[n];
+    std::fill(requested, requested + n, 0);
+
+    #ifdef USE_THREADS
+    setLocks = new pthread_mutex_t[numSets];
+    for (int s = 0; s < numSets; ++s) {
+        pthread_mutex_init(&setLocks[s], NULL);
+    }
+    #endif
+}
+
+KernelCache::~KernelCache() {
+    delete [] matrix;
+    delete [] rows;
+    delete [] tags;
+    delete [] stamps;
+    delete [] clocks;
+    delete [] requested;
+
+    #ifdef USE_THREADS
+    if (setLocks) {
+        for (int s = 0; s < numSets; ++s) {
+            pthread_mutex_destroy(&setLocks[s]);
+        }
+        delete [] setLocks;
+    }
+    #endif
+}
+
+void KernelCache::computeRow(int i, double *row) const {
+    kernel.evaluate(x->data + i * x->d, norms2[i], *x, norms2, NULL, 0, n, row);
+}
+
+double KernelCache::value(int i, int j) const {
+    if (matrix) {
+        return matrix[(size_t)i * n + j];
+    }
+    // single values are not worth caching a row for
+    return kernel(x->data + i * x->d, x->data + j * x->d, x->d);
+}
+
+double KernelCache::rowSum(int i, unsigned int const *cols, size_t count, bool cache) const {
+    double s = 0.0;
+    if (matrix) {
+        double const *row = matrix + (size_t)i * n;
+        for (size_t c = 0; c < count; ++c) {
+            s += row[cols[c]];
+        }
+        return s;
+    }
+
+    int set = i % numSets;
+    #ifdef USE_THREADS
+    pthread_mutex_lock(&setLocks[set]);
+    #endif
+
+    // find the row in its set, or the least recently used one to replace
+    int first = set * numWays;
+    int way = first;
+    for (int w = first; w < first + numWays; ++w) {
+        if (tags[w] == i) {
+            way = w;
+            break;
+        }
+        if (stamps[w] < stamps[way]) {
+            way = w;
+        }
+    }
+
+    bool held = (tags[way] == i);
+    if (! held && cache && requested[i]) {
+        computeRow(i, rows + (size_t)way * n);
+        tags[way] = i;
+        held = true;
+    }
+    if (held) {
+        double const *row = rows + (size_t)way * n;
+        stamps[way] = ++clocks[set];
+        for (size_t c = 0; c < count; ++c) {
+            s += row[cols[c]];
+        }
+    } else if (cache) {
+        requested[i] = 1;
+    }
+
+    #ifdef USE_THREADS
+    pthread_mutex_unlock(&setLocks[set]);
+    #endif
+
+    if (! held) {
+        s = kernel.sum(x->data + i * x->d, norms2[i], *x, norms2, cols, 0, (int)count);
+    }
+    return s;
+}
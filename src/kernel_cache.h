@@ -0,0 +1,88 @@
+#ifndef KERNEL_CACHE_H
+#define KERNEL_CACHE_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * KernelCache keeps kernel values between the records of a dataset, so that
+ * kernel k-means evaluates each one once rather than every iteration. If the
+ * full n x n kernel matrix fits in the given memory budget, it is computed up
+ * front, in parallel and in blocks of records (so that each block of the
+ * dataset is reused from the processor cache). Otherwise the budget holds
+ * rows of the matrix, evicted in least-recently-used order; the rows are kept
+ * in sets of a few (by row index), each with its own lock, so threads rarely
+ * contend. Computing a row costs n kernel evaluations, so a row is only
+ * cached once it has been asked for twice (records near cluster boundaries,
+ * which the accelerated algorithms examine every iteration); other sums are
+ * computed directly.
+ */
+
+#include "dataset.h"
+#include <cstddef>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
+
+class Kernel;
+
+class KernelCache {
+    public:
+        // Cache the values of kernel between the records of x (whose squared
+        // norms are norms2), using about maxBytes of memory and numThreads
+        // threads to compute a full matrix.
+        KernelCache(Kernel const &aKernel, Dataset const *aX, double const *aNorms2, size_t maxBytes, int numThreads);
+        ~KernelCache();
+
+        // Whether the full matrix is held (rather than some of its rows).
+        bool isFull() const { return matrix != NULL; }
+
+        // The number of rows of the matrix that can be held.
+        int getNumRows() const { return isFull() ? n : numSets * numWays; }
+
+        // The kernel value between records i and j.
+        double value(int i, int j) const;
+
+        // Row i of the full matrix, or NULL if it is not held.
+        double const *fullRow(int i) const { return matrix ? matrix + (size_t)i * n : NULL; }
+
+        // The sum of the kernel values between record i and the count records
+        // listed in cols. If cache is false, a row that is not held is not
+        // computed for this.
+        double rowSum(int i, unsigned int const *cols, size_t count, bool cache = true) const;
+
+    private:
+        // Compute row i of the kernel matrix into row.
+        void computeRow(int i, double *row) const;
+
+        Kernel const &kernel;
+        Dataset const *x;
+        double const *norms2;
+        int n;
+
+        // The full matrix, or NULL.
+        double *matrix;
+
+        // Otherwise, row r of set s may be held in way w of the set, in
+        // rows + ((s * numWays) + w) * n; tags gives which row each way holds
+        // (or -1), and stamps when it was last used (from the set's clock).
+        int numSets, numWays;
+        double *rows;
+        mutable int *tags;
+        mutable long long *stamps;
+        mutable long long *clocks;
+
+        // Whether each row has been asked for (and not cached) before.
+        mutable char *requested;
+
+        #ifdef USE_THREADS
+        pthread_mutex_t *setLocks;
+        #endif
+
+        // Disallow copies.
+        KernelCache(KernelCache const &);
+        KernelCache const &operator=(KernelCache const &);
+};
+
+#endif
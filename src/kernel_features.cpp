@@ -0,0 +1,208 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "kernel_features.h"
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <sstream>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
+
+// A landmark is dropped if the part of its kernel norm not explained by the
+// earlier landmarks is below this fraction of it.
+static const double NYSTROM_TOLERANCE = 1e-10;
+
+// The splitmix64 finalizer.
+static unsigned long long mix(unsigned long long z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// A uniform random number in (0, 1] determined by the seed and an index.
+static double hash_uniform(unsigned long long seed, unsigned long long index) {
+    unsigned long long h = mix(seed + mix(index * 0x9e3779b97f4a7c15ULL));
+    return ((double)(h >> 11) + 1.0) / 9007199254740992.0; // 2^53
+}
+
+struct FeaturesThreadInfo {
+    KernelFeatures const *features;
+    Dataset const *y;
+    Dataset *result;
+    int threadId, numThreads;
+    #ifdef USE_THREADS
+    pthread_t pthread_id;
+    #endif
+};
+
+static void *features_runner(void *args) {
+    FeaturesThreadInfo *ti = (FeaturesThreadInfo *)args;
+    Dataset const &y = *ti->y;
+    int startNdx = (int)((long long)y.n * ti->threadId / ti->numThreads);
+    int endNdx = (int)((long long)y.n * (ti->threadId + 1) / ti->numThreads);
+    int dimension = ti->result->d;
+    for (int i = startNdx; i < endNdx; ++i) {
+        ti->features->map(y.data + (size_t)i * y.d, ti->result->data + (size_t)i * dimension);
+    }
+    return NULL;
+}
+
+Dataset *KernelFeatures::transform(Dataset const &y, int numThreads) const {
+    Dataset *result = new Dataset(y.n, dimension);
+
+    #ifdef USE_THREADS
+    int threads = std::max(1, std::min(numThreads, y.n));
+    #else
+    int threads = 1;
+    #endif
+    FeaturesThreadInfo *info = new FeaturesThreadInfo[threads];
+    for (int t = 0; t < threads; ++t) {
+        info[t].features = this;
+        info[t].y = &y;
+        info[t].result = result;
+        info[t].threadId = t;
+        info[t].numThreads = threads;
+    }
+
+    #ifdef USE_THREADS
+    for (int t = 0; t < threads; ++t) {
+        pthread_create(&info[t].pthread_id, NULL, features_runner, &info[t]);
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(info[t].pthread_id, NULL);
+    }
+    #else
+    features_runner(&info[0]);
+    #endif
+
+    delete [] info;
+    return result;
+}
+
+NystromFeatures::NystromFeatures(Dataset const &x, Kernel const &aKernel, int numLandmarks) : kernel(aKernel) {
+    int d = x.d;
+    numSampled = std::max(1, std::min(numLandmarks, x.n));
+
+    // sample the candidate landmarks without replacement
+    int *ndx = new int[x.n];
+    for (int i = 0; i < x.n; ++i) {
+        ndx[i] = i;
+    }
+    for (int s = 0; s < numSampled; ++s) {
+        std::swap(ndx[s], ndx[s + rand() % (x.n - s)]);
+    }
+
+    // Factor the kernel matrix of the landmarks one at a time, keeping each
+    // one that adds a new direction.
+    double *kept = new double[(size_t)numSampled * d];
+    factor = new double[(size_t)numSampled * (numSampled + 1) / 2];
+    double *row = new double[numSampled];
+    dimension = 0;
+    for (int s = 0; s < numSampled; ++s) {
+        double const *p = x.data + (size_t)ndx[s] * d;
+        double diag = kernel(p, p, d);
+        double remaining = diag;
+        for (int q = 0; q < dimension; ++q) {
+            double const *lq = factor + (size_t)q * (q + 1) / 2;
+            double v = kernel(p, kept + (size_t)q * d, d);
+            for (int r = 0; r < q; ++r) {
+                v -= row[r] * lq[r];
+            }
+            row[q] = v / lq[q];
+            remaining -= row[q] * row[q];
+        }
+        if (remaining > NYSTROM_TOLERANCE * diag && remaining > 0.0) {
+            row[dimension] = sqrt(remaining);
+            std::copy(row, row + dimension + 1, factor + (size_t)dimension * (dimension + 1) / 2);
+            std::copy(p, p + d, kept + (size_t)dimension * d);
+            ++dimension;
+        }
+    }
+
+    landmarks = new Dataset(std::max(1, dimension), d);
+    std::copy(kept, kept + (size_t)dimension * d, landmarks->data);
+    landmarkNorm2 = new double[landmarks->n];
+    for (int q = 0; q < landmarks->n; ++q) {
+        double const *p = landmarks->data + (size_t)q * d;
+        landmarkNorm2[q] = std::inner_product(p, p + d, p, 0.0);
+    }
+
+    delete [] row;
+    delete [] kept;
+    delete [] ndx;
+}
+
+NystromFeatures::~NystromFeatures() {
+    delete landmarks;
+    delete [] landmarkNorm2;
+    delete [] factor;
+}
+
+void NystromFeatures::map(double const *xp, double *features) const {
+    // the kernel values with the landmarks, then forward substitution
+    int d = landmarks->d;
+    kernel.evaluate(xp, std::inner_product(xp, xp + d, xp, 0.0), *landmarks, landmarkNorm2, NULL, 0, dimension, features);
+    for (int q = 0; q < dimension; ++q) {
+        double const *lq = factor + (size_t)q * (q + 1) / 2;
+        double v = features[q];
+        for (int r = 0; r < q; ++r) {
+            v -= lq[r] * features[r];
+        }
+        features[q] = v / lq[q];
+    }
+}
+
+std::string NystromFeatures::getName() const {
+    std::ostringstream out;
+    out << "nystrom[" << numSampled << "," << dimension << "](" << kernel.getName() << ")";
+    return out.str();
+}
+
+RandomFourierFeatures::RandomFourierFeatures(GaussianKernel const &kernel, int aD, int numFeatures,
+        unsigned long long aSeed) : d(aD), tau(kernel.getTau()), seed(aSeed) {
+    dimension = std::max(1, numFeatures);
+    frequency = new double[dimension * d];
+    phase = new double[dimension];
+
+    // normal frequencies by the Box-Muller transform, two at a time
+    double const twoPi = 2.0 * M_PI;
+    for (int q = 0; q < dimension * d; q += 2) {
+        double r = sqrt(-2.0 * log(hash_uniform(seed, 2 * q))) / tau;
+        double angle = twoPi * hash_uniform(seed, 2 * q + 1);
+        frequency[q] = r * cos(angle);
+        if (q + 1 < dimension * d) {
+            frequency[q + 1] = r * sin(angle);
+        }
+    }
+    for (int f = 0; f < dimension; ++f) {
+        phase[f] = twoPi * hash_uniform(~seed, f);
+    }
+}
+
+RandomFourierFeatures::~RandomFourierFeatures() {
+    delete [] frequency;
+    delete [] phase;
+}
+
+void RandomFourierFeatures::map(double const *xp, double *features) const {
+    double scale = sqrt(2.0 / dimension);
+    for (int f = 0; f < dimension; ++f) {
+        double const *w = frequency + f * d;
+        double s = phase[f];
+        for (int dim = 0; dim < d; ++dim) {
+            s += w[dim] * xp[dim];
+        }
+        features[f] = scale * cos(s);
+    }
+}
+
+std::string RandomFourierFeatures::getName() const {
+    std::ostringstream out;
+    out << "fourier[" << dimension << "](gaussian[" << tau << "])";
+    return out.str();
+}
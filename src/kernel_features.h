@@ -0,0 +1,109 @@
+#ifndef KERNEL_FEATURES_H
+#define KERNEL_FEATURES_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * KernelFeatures maps records to explicit feature vectors whose inner
+ * products approximate a kernel, so that kernel k-means can be approximated
+ * by ordinary k-means on the features, using any of the accelerated
+ * original-space algorithms (with their bounds and threads) instead of the
+ * O(n^2) kernel algorithms.
+ *
+ * NystromFeatures samples m landmark records and uses the Nystrom
+ * approximation K ~= C W^-1 C', where C holds the kernel values between the
+ * records and the landmarks, and W those between the landmarks. With the
+ * Cholesky factorization W = L L', the features of a record x are
+ * L^-1 c(x), where c(x) are its kernel values with the landmarks. Landmarks
+ * that are (numerically) in the span of earlier ones are dropped, so the
+ * features have at most m dimensions.
+ *
+ * RandomFourierFeatures approximates a GaussianKernel with bandwidth tau by D
+ * random features sqrt(2 / D) cos(w'x + b), with each w drawn from a normal
+ * distribution with covariance I / tau^2 and b uniformly from [0, 2 pi)
+ * (Rahimi and Recht's random Fourier features). The approximation improves as
+ * D grows, independently of the number of records.
+ */
+
+#include "dataset.h"
+#include "kernel_kmeans.h"
+
+class KernelFeatures {
+    public:
+        virtual ~KernelFeatures() {}
+
+        // The dimension of the features.
+        int getDimension() const { return dimension; }
+
+        // Compute the features of the point xp into features.
+        virtual void map(double const *xp, double *features) const = 0;
+
+        // Return the features of each record of y (a new dataset, which the
+        // caller must delete), using numThreads threads.
+        Dataset *transform(Dataset const &y, int numThreads) const;
+
+        virtual std::string getName() const = 0;
+
+    protected:
+        KernelFeatures() : dimension(0) {}
+
+        int dimension;
+};
+
+class NystromFeatures : public KernelFeatures {
+    public:
+        // Sample numLandmarks records of x at random (with rand()) as the
+        // landmarks for the given kernel, which must outlive this.
+        NystromFeatures(Dataset const &x, Kernel const &aKernel, int numLandmarks);
+        virtual ~NystromFeatures();
+
+        virtual void map(double const *xp, double *features) const;
+
+        virtual std::string getName() const;
+
+    private:
+        Kernel const &kernel;
+
+        // The landmarks that were kept (dimension of them), and their squared
+        // norms.
+        Dataset *landmarks;
+        double *landmarkNorm2;
+
+        // The lower triangle of L, row by row (row r has r + 1 entries).
+        double *factor;
+
+        int numSampled;
+
+        // Disallow copies.
+        NystromFeatures(NystromFeatures const &);
+        NystromFeatures const &operator=(NystromFeatures const &);
+};
+
+class RandomFourierFeatures : public KernelFeatures {
+    public:
+        // Draw numFeatures random features for records of dimension d, as
+        // determined by the seed.
+        RandomFourierFeatures(GaussianKernel const &kernel, int d, int numFeatures, unsigned long long aSeed);
+        virtual ~RandomFourierFeatures();
+
+        virtual void map(double const *xp, double *features) const;
+
+        virtual std::string getName() const;
+
+    private:
+        int d;
+        double tau;
+        unsigned long long seed;
+
+        // The frequencies (dimension rows of d) and phases of the features.
+        double *frequency;
+        double *phase;
+
+        // Disallow copies.
+        RandomFourierFeatures(RandomFourierFeatures const &);
+        RandomFourierFeatures const &operator=(RandomFourierFeatures const &);
+};
+
+#endif
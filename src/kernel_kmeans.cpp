@@ -5,9 +5,91 @@
  */
 
 #include "kernel_kmeans.h"
+#include <algorithm>
 #include <cassert>
 
-KernelKmeans::KernelKmeans(Kernel const *k) : kernel(*k) {
+// The number of kernel values evaluated per block (on the stack).
+static const int KERNEL_BLOCK = 256;
+
+// Evaluate kernel (a kernel class with a value() policy) between a and count
+// records of x, as for Kernel::evaluate(). The inner products are computed for
+// four records at a time, each summed in the same order as operator() does,
+// and the kernel is then applied to them in a separate loop.
+template <class K>
+static void evaluate_block(K const &kernel, double const *a, double aNorm2, Dataset const &x, double const *norms2,
+        unsigned int const *ndx, int first, int count, double *values) {
+    int d = x.d;
+    int c = 0;
+    for (; c + 4 <= count; c += 4) {
+        double const *b0 = x.data + (size_t)(ndx ? ndx[c] : first + c) * d;
+        double const *b1 = x.data + (size_t)(ndx ? ndx[c + 1] : first + c + 1) * d;
+        double const *b2 = x.data + (size_t)(ndx ? ndx[c + 2] : first + c + 2) * d;
+        double const *b3 = x.data + (size_t)(ndx ? ndx[c + 3] : first + c + 3) * d;
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+        for (int dim = 0; dim < d; ++dim) {
+            s0 += a[dim] * b0[dim];
+            s1 += a[dim] * b1[dim];
+            s2 += a[dim] * b2[dim];
+            s3 += a[dim] * b3[dim];
+        }
+        values[c] = s0;
+        values[c + 1] = s1;
+        values[c + 2] = s2;
+        values[c + 3] = s3;
+    }
+    for (; c < count; ++c) {
+        double const *b = x.data + (size_t)(ndx ? ndx[c] : first + c) * d;
+        double s = 0.0;
+        for (int dim = 0; dim < d; ++dim) {
+            s += a[dim] * b[dim];
+        }
+        values[c] = s;
+    }
+
+    for (c = 0; c < count; ++c) {
+        values[c] = kernel.value(values[c], aNorm2, norms2[ndx ? ndx[c] : first + c]);
+    }
+}
+
+void Kernel::evaluate(double const *a, double, Dataset const &x, double const *,
+        unsigned int const *ndx, int first, int count, double *values) const {
+    for (int c = 0; c < count; ++c) {
+        values[c] = (*this)(a, x.data + (size_t)(ndx ? ndx[c] : first + c) * x.d, x.d);
+    }
+}
+
+double Kernel::sum(double const *a, double aNorm2, Dataset const &x, double const *norms2,
+        unsigned int const *ndx, int first, int count) const {
+    double values[KERNEL_BLOCK];
+    double s = 0.0;
+    for (int c = 0; c < count; c += KERNEL_BLOCK) {
+        int block = std::min(KERNEL_BLOCK, count - c);
+        evaluate(a, aNorm2, x, norms2, ndx ? ndx + c : NULL, first + c, block, values);
+        for (int q = 0; q < block; ++q) {
+            s += values[q];
+        }
+    }
+    return s;
+}
+
+void LinearKernel::evaluate(double const *a, double aNorm2, Dataset const &x, double const *norms2,
+        unsigned int const *ndx, int first, int count, double *values) const {
+    evaluate_block(*this, a, aNorm2, x, norms2, ndx, first, count, values);
+}
+
+void PolynomialKernel::evaluate(double const *a, double aNorm2, Dataset const &x, double const *norms2,
+        unsigned int const *ndx, int first, int count, double *values) const {
+    evaluate_block(*this, a, aNorm2, x, norms2, ndx, first, count, values);
+}
+
+void GaussianKernel::evaluate(double const *a, double aNorm2, Dataset const &x, double const *norms2,
+        unsigned int const *ndx, int first, int count, double *values) const {
+    evaluate_block(*this, a, aNorm2, x, norms2, ndx, first, count, values);
+}
+
+KernelKmeans::KernelKmeans(Kernel const *k) : kernel(*k), kernelCache(NULL), kernelCacheBytes(0),
+    kernelNeighbors(NULL), kernelThreshold(0.0), pointNorm2(NULL), memberCounts(NULL), incremental(true), statAssignment(NULL), statSize(NULL), clusterSums(NULL),
+    centerProducts(NULL), threadProducts(NULL), threadCross(NULL), threadSize(NULL), moveValues(NULL) {
     #ifdef USE_THREADS
     convergenceLock = NULL;
     #endif
@@ -17,24 +99,84 @@ void KernelKmeans::initialize(Dataset const *aX, unsigned short aK, unsigned sho
     Kmeans::initialize(aX, aK, initialAssignment, aNumThreads);
 
     cc.resize(k);
-    memberships.clear();
-    memberships.resize(k);
+    std::fill(cc.begin(), cc.end(), 0.0);
+    // all clusters start out empty
+    memberships.ndx.resize(n);
+    memberships.offset.assign(k + 1, 0);
+    newMemberships.ndx.resize(n);
+    newMemberships.offset.assign(k + 1, 0);
+    newCc.resize(k);
+    std::fill(newCc.begin(), newCc.end(), 0.0);
+    memberCounts = new int[numThreads * k];
+
+    if (incremental) {
+        // no record is reflected in the statistics yet
+        statAssignment = new unsigned short[n];
+        statSize = new int[k];
+        clusterSums = new double[(size_t)n * k];
+        centerProducts = new double[k * k];
+        threadProducts = new double[numThreads * k * k];
+        threadCross = new double[numThreads * k];
+        threadSize = new int[numThreads * k];
+        moveValues = new double[n];
+        std::fill(statAssignment, statAssignment + n, k);
+        std::fill(statSize, statSize + k, 0);
+        std::fill(clusterSums, clusterSums + (size_t)n * k, 0.0);
+        std::fill(centerProducts, centerProducts + k * k, 0.0);
+        moves.resize(numThreads);
+    }
+
+    pointNorm2 = new double[n];
+    for (int i = 0; i < n; ++i) {
+        pointNorm2[i] = std::inner_product(x->data + i * d, x->data + (i + 1) * d, x->data + i * d, 0.0);
+    }
+
+    double cutoffDist2 = (kernelThreshold > 0.0) ? kernel.cutoffDist2(kernelThreshold) : -1.0;
+    if (cutoffDist2 >= 0.0) {
+        kernelNeighbors = new KernelNeighbors(kernel, x, pointNorm2, kernelThreshold, cutoffDist2, numThreads);
+    } else if (kernelCacheBytes > 0) {
+        kernelCache = new KernelCache(kernel, x, pointNorm2, kernelCacheBytes, numThreads);
+    }
 
     #ifdef USE_THREADS
     convergenceLock = new pthread_mutex_t;
     pthread_mutex_init(convergenceLock, NULL);
-
-    clusterLocks.resize(k);
-    for (int j = 0; j < k; ++j) {
-        pthread_mutex_init(&clusterLocks[j], NULL);
-    }
     #endif
 }
 
 void KernelKmeans::free() {
     Kmeans::free();
     cc.clear();
-    memberships.clear();
+    memberships.ndx.clear();
+    memberships.offset.clear();
+    newMemberships.ndx.clear();
+    newMemberships.offset.clear();
+    newCc.clear();
+    delete [] memberCounts;
+    memberCounts = NULL;
+    delete [] statAssignment;
+    delete [] statSize;
+    delete [] clusterSums;
+    delete [] centerProducts;
+    delete [] threadProducts;
+    delete [] threadCross;
+    delete [] threadSize;
+    statAssignment = NULL;
+    statSize = NULL;
+    clusterSums = NULL;
+    centerProducts = NULL;
+    threadProducts = NULL;
+    threadCross = NULL;
+    threadSize = NULL;
+    delete [] moveValues;
+    moveValues = NULL;
+    moves.clear();
+    delete kernelCache;
+    kernelCache = NULL;
+    delete kernelNeighbors;
+    kernelNeighbors = NULL;
+    delete [] pointNorm2;
+    pointNorm2 = NULL;
 
     #ifdef USE_THREADS
     if (convergenceLock) {
@@ -45,69 +187,225 @@ void KernelKmeans::free() {
     #endif
 }
 
-double KernelKmeans::centerCenterInnerProductGeneral(std::vector<unsigned int> const &members1, std::vector<unsigned int> const &members2) const {
+double KernelKmeans::centerCenterInnerProductGeneral(unsigned int const *members1, size_t count1, unsigned int const *members2, size_t count2) const {
     double s = 0.0;
-    std::vector<unsigned int>::const_iterator i, j;
-    if (&members1 == &members2) {
-        for (i = members1.begin(); i != members1.end(); ++i) {
-            s += kernel(x->data + *i * d, x->data + *i * d, d);
-            for (j = i + 1; j != members1.end(); ++j) {
-                s += 2.0 * kernel(x->data + *i * d, x->data + *j * d, d);
-            }
+    if (kernelNeighbors) {
+        for (size_t r = 0; r < count1; ++r) {
+            s += kernelNeighbors->rowSum(members1[r], members2, count2);
+        }
+    } else if (kernelCache) {
+        // sum rows of the kernel matrix (only those already cached, unless it
+        // is full), taking them from the smaller cluster since it is symmetric
+        bool firstRows = count1 <= count2;
+        unsigned int const *rows = firstRows ? members1 : members2;
+        unsigned int const *cols = firstRows ? members2 : members1;
+        size_t numRows = firstRows ? count1 : count2;
+        size_t numCols = firstRows ? count2 : count1;
+        for (size_t r = 0; r < numRows; ++r) {
+            s += kernelCache->rowSum(rows[r], cols, numCols, false);
+        }
+    } else if (members1 == members2 && count1 == count2) {
+        for (size_t r = 0; r < count1; ++r) {
+            unsigned int i = members1[r];
+            s += kernel(x->data + i * d, x->data + i * d, d);
+            addKernelValues(i, members1 + r + 1, count1 - (r + 1), 2.0, &s);
         }
     } else {
-        for (i = members1.begin(); i != members1.end(); ++i) {
-            for (j = members2.begin(); j != members2.end(); ++j) {
-                s += kernel(x->data + *i * d, x->data + *j * d, d);
-            }
+        for (size_t r = 0; r < count1; ++r) {
+            addKernelValues(members1[r], members2, count2, 1.0, &s);
         }
     }
 
-    size_t n = members1.size() * members2.size();
+    size_t n = count1 * count2;
     if (n > 0) { s /= n; }
 
     return s;
 }
 
-double KernelKmeans::pointCenterInnerProductGeneral(int i, std::vector<unsigned int> const &members) const {
+double KernelKmeans::pointCenterInnerProductGeneral(int i, unsigned int const *members, size_t count) const {
     double s = 0.0;
-    std::vector<unsigned int>::const_iterator j;
-    for (j = members.begin(); j != members.end(); ++j) {
-        s += kernel(x->data + i * d, x->data + *j * d, d);
+    if (kernelNeighbors) {
+        s = kernelNeighbors->rowSum(i, members, count);
+    } else if (kernelCache) {
+        s = kernelCache->rowSum(i, members, count);
+    } else {
+        addKernelValues(i, members, count, 1.0, &s);
     }
 
-    size_t n = members.size();
-    if (n > 0) { s /= n; }
+    if (count > 0) { s /= count; }
 
     return s;
 }
 
-void KernelKmeans::computeMemberships(int threadId, std::vector<std::vector<unsigned int> > *membershipResult, std::vector<double> *ccResult) {
-    std::vector<std::vector<unsigned int> > threadMemberships(k);
+void KernelKmeans::addKernelValues(int i, unsigned int const *ndx, size_t count, double scale, double *s) const {
+    double values[KERNEL_BLOCK];
+    for (size_t first = 0; first < count; first += KERNEL_BLOCK) {
+        int block = (int)std::min((size_t)KERNEL_BLOCK, count - first);
+        kernel.evaluate(x->data + i * d, pointNorm2[i], *x, pointNorm2, ndx + first, 0, block, values);
+        for (int c = 0; c < block; ++c) {
+            *s += scale * values[c];
+        }
+    }
+}
+
+void KernelKmeans::computeMemberships(int threadId, Memberships *membershipResult, std::vector<double> *ccResult) {
+    int startNdx = start(threadId);
+    int endNdx = end(threadId);
 
+    // count this thread's points in each cluster
+    int *counts = memberCounts + threadId * k;
+    std::fill(counts, counts + k, 0);
+    for (int i = startNdx; i < endNdx; ++i) {
+        ++counts[assignment[i]];
+    }
+    synchronizeAllThreads();
+
+    // Each cluster's members start after those of the earlier clusters, and
+    // each thread's members of a cluster after those of the earlier threads
+    // (which have lower indexes).
     if (threadId == 0) {
+        int offset = 0;
         for (int j = 0; j < k; ++j) {
-            membershipResult->at(j).clear();
+            membershipResult->offset[j] = offset;
+            for (int t = 0; t < numThreads; ++t) {
+                int count = memberCounts[t * k + j];
+                memberCounts[t * k + j] = offset;
+                offset += count;
+            }
         }
+        membershipResult->offset[k] = offset;
     }
     synchronizeAllThreads();
 
-    for (int i = start(threadId); i < end(threadId); ++i) {
-        threadMemberships[assignment[i]].push_back(i);
+    unsigned int *ndx = membershipResult->ndx.data();
+    for (int i = startNdx; i < endNdx; ++i) {
+        ndx[counts[assignment[i]]++] = i;
+    }
+    synchronizeAllThreads();
+
+    for (int j = threadId; j < k; j += numThreads) {
+        ccResult->at(j) = centerCenterInnerProductGeneral(membershipResult->members(j), membershipResult->size(j),
+                                                          membershipResult->members(j), membershipResult->size(j));
+    }
+}
+
+void KernelKmeans::updateClusterStatistics(int threadId, bool findMovement) {
+    if (! clusterSums) {
+        // rebuild the memberships and center products, and compare them to
+        // the previous ones
+        computeMemberships(threadId, &newMemberships, &newCc);
+        synchronizeAllThreads();
+        if (findMovement) {
+            for (int j = threadId; j < k; j += numThreads) {
+                double cross = centerCenterInnerProductGeneral(memberships.members(j), memberships.size(j),
+                                                               newMemberships.members(j), newMemberships.size(j));
+                centerMovement[j] = sqrt(cc[j] - 2.0 * cross + newCc[j]);
+            }
+        }
+        synchronizeAllThreads();
+        if (threadId == 0) {
+            memberships.ndx.swap(newMemberships.ndx);
+            memberships.offset.swap(newMemberships.offset);
+            cc.swap(newCc);
+        }
+        synchronizeAllThreads();
+        return;
+    }
+
+    int startNdx = start(threadId);
+    int endNdx = end(threadId);
+
+    // list the records of this thread that changed clusters
+    std::vector<Move> &threadMoves = moves[threadId];
+    threadMoves.clear();
+    for (int i = startNdx; i < endNdx; ++i) {
+        if (assignment[i] != statAssignment[i]) {
+            Move move = { i, statAssignment[i], assignment[i] };
+            threadMoves.push_back(move);
+        }
     }
     synchronizeAllThreads();
 
-    for (int j = 0; j < k; ++j) {
-        lockCluster(j);
-        std::copy(threadMemberships[j].begin(), threadMemberships[j].end(), std::back_insert_iterator<std::vector<unsigned int> >(membershipResult->at(j)));
-        unlockCluster(j);
+    // move each changed record's kernel values, for this thread's records,
+    // from the sum of its old cluster to that of its new one
+    for (int t = 0; t < numThreads; ++t) {
+        for (size_t q = 0; q < moves[t].size(); ++q) {
+            Move const &move = moves[t][q];
+            if (kernelNeighbors) {
+                // only the neighbors of the record have nonzero values
+                unsigned int const *first = kernelNeighbors->neighbors(move.ndx);
+                unsigned int const *last = first + kernelNeighbors->count(move.ndx);
+                double const *values = kernelNeighbors->values(move.ndx);
+                for (unsigned int const *p = std::lower_bound(first, last, (unsigned int)startNdx);
+                        p != last && *p < (unsigned int)endNdx; ++p) {
+                    if (move.from < k) {
+                        clusterSums[(size_t)*p * k + move.from] -= values[p - first];
+                    }
+                    clusterSums[(size_t)*p * k + move.to] += values[p - first];
+                }
+                continue;
+            }
+            double const *values = kernelCache ? kernelCache->fullRow(move.ndx) : NULL;
+            if (! values) {
+                kernel.evaluate(x->data + move.ndx * d, pointNorm2[move.ndx], *x, pointNorm2,
+                        NULL, startNdx, endNdx - startNdx, moveValues + startNdx);
+                values = moveValues;
+            }
+            for (int i = startNdx; i < endNdx; ++i) {
+                if (move.from < k) {
+                    clusterSums[(size_t)i * k + move.from] -= values[i];
+                }
+                clusterSums[(size_t)i * k + move.to] += values[i];
+            }
+        }
+    }
+
+    // accumulate this thread's part of the center products, the products of
+    // each center with its previous self, and the cluster sizes
+    double *products = threadProducts + threadId * k * k;
+    double *cross = threadCross + threadId * k;
+    int *size = threadSize + threadId * k;
+    std::fill(products, products + k * k, 0.0);
+    std::fill(cross, cross + k, 0.0);
+    std::fill(size, size + k, 0);
+    for (int i = startNdx; i < endNdx; ++i) {
+        double const *sums = clusterSums + (size_t)i * k;
+        double *row = products + assignment[i] * k;
+        for (int j = 0; j < k; ++j) {
+            row[j] += sums[j];
+        }
+        if (statAssignment[i] < k) {
+            cross[statAssignment[i]] += sums[statAssignment[i]];
+        }
+        ++size[assignment[i]];
+        statAssignment[i] = assignment[i];
     }
     synchronizeAllThreads();
 
-    for (int j = 0; j < k; ++j) {
-        if (j % numThreads == threadId) {
-            ccResult->at(j) = centerCenterInnerProductGeneral(membershipResult->at(j), membershipResult->at(j));
+    // combine the threads' parts, for the clusters of this thread
+    for (int a = threadId; a < k; a += numThreads) {
+        int oldSize = statSize[a];
+        double oldCc = cc[a];
+        double crossProduct = 0.0;
+        int newSize = 0;
+        double *row = centerProducts + a * k;
+        std::fill(row, row + k, 0.0);
+        for (int t = 0; t < numThreads; ++t) {
+            double const *products = threadProducts + (t * k + a) * k;
+            for (int j = 0; j < k; ++j) {
+                row[j] += products[j];
+            }
+            crossProduct += threadCross[t * k + a];
+            newSize += threadSize[t * k + a];
+        }
+
+        statSize[a] = newSize;
+        cc[a] = (newSize > 0) ? row[a] / ((double)newSize * newSize) : 0.0;
+        if (findMovement) {
+            double size = (double)oldSize * newSize;
+            double movement2 = oldCc - 2.0 * ((size > 0.0) ? crossProduct / size : 0.0) + cc[a];
+            centerMovement[a] = sqrt(std::max(0.0, movement2));
         }
     }
+    synchronizeAllThreads();
 }
-
@@ -8,10 +8,22 @@
  *
  * KernelKmeans is a base class for all k-means algorithms that use kernels.
  * Kernel-based algorithms don't represent the centers explicitly, but instead
- * implicitly by the memberships in each cluster.
+ * implicitly by the memberships in each cluster. The kernel values between
+ * records can be kept in a KernelCache (see setKernelCacheSize()), or, for a
+ * kernel that decays with distance, truncated to a sparse KernelNeighbors
+ * matrix (see setKernelThreshold()).
+ *
+ * By default, the cluster statistics are maintained incrementally: for each
+ * record and cluster, the sum of the kernel values between the record and the
+ * cluster's members is updated for only the records that changed clusters,
+ * and the center inner products follow from those sums in O(nk). An
+ * iteration then costs O(n) kernel evaluations per reassigned record, rather
+ * than O(n^2) to recompute the memberships and center products.
  */
 
 #include "kmeans.h"
+#include "kernel_cache.h"
+#include "kernel_neighbors.h"
 #include "general_functions.h"
 #include <cmath>
 #include <vector>
@@ -24,45 +36,106 @@ class Kernel {
         virtual ~Kernel() {}
         virtual double operator()(double const *, double const *, int) const = 0;
         virtual std::string getName() const = 0;
+
+        // Evaluate the kernel between the point a and count records of x
+        // (those listed in ndx, or records first, first + 1, ... if ndx is
+        // NULL) into values. aNorm2 and norms2 are the squared norms of a and
+        // of the records of x. This evaluates a whole block per call, so it is
+        // much faster than operator() on each record.
+        virtual void evaluate(double const *a, double aNorm2, Dataset const &x, double const *norms2,
+                unsigned int const *ndx, int first, int count, double *values) const;
+
+        // The sum of the values evaluate() would give, in order.
+        double sum(double const *a, double aNorm2, Dataset const &x, double const *norms2,
+                unsigned int const *ndx, int first, int count) const;
+
+        // The squared distance beyond which the kernel value between two
+        // points is below threshold, or a negative number if the kernel does
+        // not decay with distance.
+        virtual double cutoffDist2(double threshold) const { return -1.0; }
 };
 
+/* The kernels below evaluate blocks with evaluate_block() (in
+ * kernel_kmeans.cpp), which computes the inner products of a with four
+ * records at a time and then applies the kernel's value() -- its policy,
+ * called without virtual dispatch -- to each inner product in a separate
+ * loop. operator() uses the same value(), so both give identical results.
+ */
+
 class LinearKernel : public Kernel {
     public:
         virtual double operator()(double const *a, double const *b, int dimension) const { 
-            return std::inner_product(a, a + dimension, b, 0.0);
+            return value(std::inner_product(a, a + dimension, b, 0.0), 0.0, 0.0);
         }
+        virtual void evaluate(double const *a, double aNorm2, Dataset const &x, double const *norms2,
+                unsigned int const *ndx, int first, int count, double *values) const;
         virtual std::string getName() const { return "linear"; }
+
+        // The kernel value, given the inner product and squared norms.
+        double value(double dot, double, double) const { return dot; }
 };
 
 class PolynomialKernel : public Kernel {
     public:
-        PolynomialKernel(double cc, double p) : c(cc), power(p) {}
+        PolynomialKernel(double cc, double p) : c(cc), power(p),
+            intPower((p == floor(p) && p >= 0.0 && p <= 64.0) ? (int)p : -1) {}
         virtual double operator()(double const *a, double const *b, int dimension) const { 
-            return pow(std::inner_product(a, a + dimension, b, 0.0) + c, power);
+            return value(std::inner_product(a, a + dimension, b, 0.0), 0.0, 0.0);
         }
+        virtual void evaluate(double const *a, double aNorm2, Dataset const &x, double const *norms2,
+                unsigned int const *ndx, int first, int count, double *values) const;
         virtual std::string getName() const {
             std::ostringstream out;
             out << "poly[" << c << "," << power << "]";
             return out.str();
         }
+
+        // The kernel value, given the inner product and squared norms.
+        // Integer powers are taken by repeated squaring rather than pow().
+        double value(double dot, double, double) const {
+            double base = dot + c;
+            if (intPower < 0) {
+                return pow(base, power);
+            }
+            double result = 1.0;
+            for (int e = intPower; e > 0; e >>= 1) {
+                if (e & 1) {
+                    result *= base;
+                }
+                base *= base;
+            }
+            return result;
+        }
     protected:
         double c, power;
+
+        // The power if it is a small non-negative integer, otherwise -1.
+        int intPower;
 };
 
 class GaussianKernel : public Kernel {
     public:
         GaussianKernel(double t) : tau(t), twoTau2(2.0 * t * t) {}
         virtual double operator()(double const *a, double const *b, int dimension) const { 
-            double d2 = std::inner_product(a, a + dimension, a, 0.0)
-                        - 2 * std::inner_product(a, a + dimension, b, 0.0)
-                        + std::inner_product(b, b + dimension, b, 0.0);
-            return exp(-d2 / twoTau2);
+            return value(std::inner_product(a, a + dimension, b, 0.0),
+                    std::inner_product(a, a + dimension, a, 0.0),
+                    std::inner_product(b, b + dimension, b, 0.0));
         }
+        virtual void evaluate(double const *a, double aNorm2, Dataset const &x, double const *norms2,
+                unsigned int const *ndx, int first, int count, double *values) const;
         virtual std::string getName() const {
             std::ostringstream out;
             out << "gaussian[" << tau << "]";
             return out.str();
         }
+        double getTau() const { return tau; }
+        virtual double cutoffDist2(double threshold) const { return -twoTau2 * log(threshold); }
+
+        // The kernel value, given the inner product and squared norms.
+        double value(double dot, double aNorm2, double bNorm2) const {
+            double d2 = aNorm2 - 2 * dot + bNorm2;
+            return exp(-d2 / twoTau2);
+        }
     protected:
         double tau;
         double twoTau2;
@@ -72,27 +145,97 @@ class KernelKmeans : public Kmeans {
     public:
         KernelKmeans(Kernel const *k);
         virtual ~KernelKmeans() { free(); delete &kernel; }
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
         virtual void free();
 
+        // Cache kernel values using up to the given number of bytes (the full
+        // kernel matrix if it fits, otherwise some of its rows), from the next
+        // initialize() on. 0 (the default) disables the cache.
+        void setKernelCacheSize(size_t bytes) { kernelCacheBytes = bytes; }
+
+        // Whether to maintain the cluster statistics incrementally (the
+        // default), using n * k doubles, rather than rebuilding the
+        // memberships and center products every iteration. Takes effect from
+        // the next initialize() on.
+        void setIncremental(bool aIncremental) { incremental = aIncremental; }
+
+        // Treat kernel values below the given threshold (in (0, 1)) as zero,
+        // from the next initialize() on, if the kernel decays with distance
+        // (the gaussian kernel): the neighbors of each record within the
+        // cutoff are found once, and kernel sums only visit those. This
+        // replaces the kernel cache. 0 (the default) uses the exact kernel.
+        void setKernelThreshold(double threshold) { kernelThreshold = threshold; }
+
     protected:
         // Functions for computing inner products with kernels.
-        double centerCenterInnerProductGeneral(std::vector<unsigned int> const &members1, std::vector<unsigned int> const &members2) const;
-        double pointCenterInnerProductGeneral(int xndx, std::vector<unsigned int> const &members) const;
+        double centerCenterInnerProductGeneral(unsigned int const *members1, size_t count1, unsigned int const *members2, size_t count2) const;
+        double pointCenterInnerProductGeneral(int xndx, unsigned int const *members, size_t count) const;
 
         virtual double centerCenterInnerProduct(unsigned short c1, unsigned short c2) const {
-            return centerCenterInnerProductGeneral(memberships[c1], memberships[c2]);
+            if (c1 == c2) {
+                return cc[c1];
+            }
+            if (clusterSums) {
+                double size = (double)statSize[c1] * statSize[c2];
+                return (size > 0.0) ? centerProducts[c1 * k + c2] / size : 0.0;
+            }
+            return centerCenterInnerProductGeneral(memberships.members(c1), memberships.size(c1),
+                                                   memberships.members(c2), memberships.size(c2));
         }
         virtual double pointCenterInnerProduct(int xndx, unsigned short cluster) const {
-            return pointCenterInnerProductGeneral(xndx, memberships[cluster]);
+            if (clusterSums) {
+                return (statSize[cluster] > 0) ? clusterSums[(size_t)xndx * k + cluster] / statSize[cluster] : 0.0;
+            }
+            return pointCenterInnerProductGeneral(xndx, memberships.members(cluster), memberships.size(cluster));
         }
         virtual double pointPointInnerProduct(int x1, int x2) const {
+            if (kernelNeighbors) {
+                return kernelNeighbors->value(x1, x2);
+            }
+            if (kernelCache) {
+                return kernelCache->value(x1, x2);
+            }
             return kernel(x->data + x1 * d, x->data + x2 * d, d);
         }
 
-        // Compute the memberships and center inner product for the points
-        // assigned to this thread. 
-        void computeMemberships(int threadId, std::vector<std::vector<unsigned int> > *membershipResult, std::vector<double> *ccResult);
+        // The members of each cluster, in one array in index order: those of
+        // cluster j are ndx[offset[j]] ... ndx[offset[j + 1] - 1].
+        struct Memberships {
+            std::vector<unsigned int> ndx;
+            std::vector<int> offset;
+
+            unsigned int const *members(int j) const { return ndx.data() + offset[j]; }
+            size_t size(int j) const { return offset[j + 1] - offset[j]; }
+        };
+
+        // Rebuild the memberships from the assignment (by a counting sort:
+        // each thread counts its points in each cluster, the counts are
+        // turned into offsets, and each thread places its points), and the
+        // center inner products for the clusters assigned to this thread.
+        // Every thread must call this.
+        void computeMemberships(int threadId, Memberships *membershipResult, std::vector<double> *ccResult);
+
+        // Bring the cluster statistics up to date with the current assignment
+        // and, if findMovement, set centerMovement to how far each center has
+        // moved (in kernel space) since the last call. Every thread must call
+        // this; it synchronizes them before returning.
+        void updateClusterStatistics(int threadId, bool findMovement);
+
+        // Add scale times the kernel value between record i and each of the
+        // count records listed in ndx to *s, in order.
+        void addKernelValues(int i, unsigned int const *ndx, size_t count, double scale, double *s) const;
+
+        // The kernel value between records i and j.
+        double kernelValue(int i, int j) const {
+            if (kernelNeighbors) {
+                return kernelNeighbors->value(i, j);
+            }
+            if (kernelCache) {
+                return kernelCache->value(i, j);
+            }
+            return kernel(x->data + i * d, x->data + j * d, d);
+        }
 
         // Convenience function to determine convergence across multiple
         // threads.
@@ -106,34 +249,67 @@ class KernelKmeans : public Kmeans {
             #endif
         }
 
-        // Convenience function for locking/unlocking a cluster.
-        void lockCluster(unsigned short j) {
-            #ifdef USE_THREADS
-            pthread_mutex_lock(&clusterLocks[j]);
-            #endif
-        }
-
-        void unlockCluster(unsigned short j) {
-            #ifdef USE_THREADS
-            pthread_mutex_unlock(&clusterLocks[j]);
-            #endif
-        }
-
         // A reference to the kernel this algorithm is using.
         Kernel const &kernel;
 
+        // The cache of kernel values (or NULL), and its size in bytes.
+        KernelCache *kernelCache;
+        size_t kernelCacheBytes;
+
+        // The truncated kernel matrix (or NULL), and the threshold below
+        // which kernel values are dropped (0 for none).
+        KernelNeighbors *kernelNeighbors;
+        double kernelThreshold;
+
+        // The squared norm of each record, for evaluating the kernel in
+        // blocks.
+        double *pointNorm2;
+
         #ifdef USE_THREADS
         // Method of detecting convergence across multiple threads.
         pthread_mutex_t *convergenceLock;
-        std::vector<pthread_mutex_t> clusterLocks;
         #endif
 
-        // For each cluster, a list of the indexes of the points that are
-        // members in that cluster.
-        std::vector<std::vector<unsigned int> > memberships;
+        // For each cluster, the indexes of the points that are members in
+        // that cluster.
+        Memberships memberships;
 
         // The inner product for each center with itself.
         std::vector<double> cc;
+
+        // The memberships and center inner products being built, which
+        // replace the ones above once center movement has been found.
+        Memberships newMemberships;
+        std::vector<double> newCc;
+
+        // The number of points of each thread in each cluster, and then where
+        // the thread places the next one, memberCounts[threadId * k + j].
+        int *memberCounts;
+
+        // For incremental statistics: the assignment (k for none) and cluster
+        // sizes they reflect; the sum of the kernel values between record i
+        // and the members of cluster j, clusterSums[i * k + j]; and the sums
+        // of those over the members of cluster a, centerProducts[a * k + j]
+        // (so <c_a, c_j> is that divided by the two cluster sizes). Each
+        // thread accumulates its records' part of the products, the
+        // cross-products for center movement, and the sizes in the thread*
+        // arrays (k * k, k and k entries per thread), lists the records it
+        // owns that changed clusters in moves, and evaluates the kernel for
+        // its records into its part of moveValues (n entries).
+        bool incremental;
+        unsigned short *statAssignment;
+        int *statSize;
+        double *clusterSums;
+        double *centerProducts;
+        double *threadProducts;
+        double *threadCross;
+        int *threadSize;
+        double *moveValues;
+        struct Move {
+            int ndx;
+            unsigned short from, to;
+        };
+        std::vector<std::vector<Move> > moves;
 };
 
 
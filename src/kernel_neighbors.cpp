@@ -0,0 +1,197 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "kernel_neighbors.h"
+#include "kernel_kmeans.h"
+#include "kd_tree.h"
+#include <algorithm>
+#include <vector>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
+
+// The number of candidate neighbors evaluated per call to the kernel.
+static const int NEIGHBOR_BLOCK = 256;
+
+struct NeighborsThreadInfo {
+    Kernel const *kernel;
+    Dataset const *x;
+    double const *norms2;
+    KdTree const *tree;
+    double threshold, radius2;
+    size_t *counts;
+    std::vector<unsigned int> ndx;
+    std::vector<double> vals;
+    int threadId, numThreads;
+    #ifdef USE_THREADS
+    pthread_t pthread_id;
+    #endif
+};
+
+// Find the neighbors of this thread's records, in index order, into its ndx
+// and vals, and the number of them for record i into counts[i].
+static void *neighbors_runner(void *args) {
+    NeighborsThreadInfo *ti = (NeighborsThreadInfo *)args;
+    Dataset const &x = *ti->x;
+    KdTree const &tree = *ti->tree;
+    int d = x.d;
+    int startNdx = (int)((long long)x.n * ti->threadId / ti->numThreads);
+    int endNdx = (int)((long long)x.n * (ti->threadId + 1) / ti->numThreads);
+
+    std::vector<int> stack;
+    std::vector<unsigned int> candidates;
+    double values[NEIGHBOR_BLOCK];
+    for (int i = startNdx; i < endNdx; ++i) {
+        double const *p = x.data + i * d;
+
+        // collect the records of the leaves whose boxes are within the radius
+        candidates.clear();
+        stack.push_back(0);
+        while (! stack.empty()) {
+            int node = stack.back();
+            stack.pop_back();
+
+            double const *lower = tree.lower + node * d;
+            double const *upper = tree.upper + node * d;
+            double gap2 = 0.0;
+            for (int dim = 0; dim < d && gap2 <= ti->radius2; ++dim) {
+                double gap = std::max(0.0, std::max(lower[dim] - p[dim], p[dim] - upper[dim]));
+                gap2 += gap * gap;
+            }
+            if (gap2 > ti->radius2) {
+                continue;
+            }
+
+            if (tree.isLeaf(node)) {
+                for (int q = tree.nodeStart[node]; q < tree.nodeEnd[node]; ++q) {
+                    candidates.push_back(tree.index[q]);
+                }
+            } else {
+                stack.push_back(tree.right(node));
+                stack.push_back(tree.left(node));
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        // keep the candidates whose kernel value reaches the threshold
+        size_t before = ti->ndx.size();
+        for (size_t first = 0; first < candidates.size(); first += NEIGHBOR_BLOCK) {
+            int block = (int)std::min((size_t)NEIGHBOR_BLOCK, candidates.size() - first);
+            ti->kernel->evaluate(p, ti->norms2[i], x, ti->norms2, candidates.data() + first, 0, block, values);
+            for (int c = 0; c < block; ++c) {
+                if (values[c] >= ti->threshold) {
+                    ti->ndx.push_back(candidates[first + c]);
+                    ti->vals.push_back(values[c]);
+                }
+            }
+        }
+        ti->counts[i] = ti->ndx.size() - before;
+    }
+    return NULL;
+}
+
+KernelNeighbors::KernelNeighbors(Kernel const &kernel, Dataset const *x, double const *norms2,
+        double threshold, double cutoffDist2, int numThreads) : n(x->n) {
+    KdTree tree(x, numThreads);
+
+    // The kernel computes distances from the norms, which differs from the
+    // distances to the boxes by rounding; search a little further so that no
+    // neighbor is missed (the threshold decides).
+    double maxNorm2 = 0.0;
+    for (int i = 0; i < n; ++i) {
+        maxNorm2 = std::max(maxNorm2, norms2[i]);
+    }
+    double radius2 = cutoffDist2 + 1e-9 * (cutoffDist2 + maxNorm2);
+
+    #ifdef USE_THREADS
+    int threads = std::max(1, std::min(numThreads, n));
+    #else
+    int threads = 1;
+    #endif
+    offset = new size_t[n + 1];
+    NeighborsThreadInfo *info = new NeighborsThreadInfo[threads];
+    for (int t = 0; t < threads; ++t) {
+        info[t].kernel = &kernel;
+        info[t].x = x;
+        info[t].norms2 = norms2;
+        info[t].tree = &tree;
+        info[t].threshold = threshold;
+        info[t].radius2 = radius2;
+        info[t].counts = offset + 1;
+        info[t].threadId = t;
+        info[t].numThreads = threads;
+    }
+
+    #ifdef USE_THREADS
+    for (int t = 0; t < threads; ++t) {
+        pthread_create(&info[t].pthread_id, NULL, neighbors_runner, &info[t]);
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(info[t].pthread_id, NULL);
+    }
+    #else
+    neighbors_runner(&info[0]);
+    #endif
+
+    // the threads found the neighbors of consecutive ranges of records, so
+    // their lists follow one another
+    offset[0] = 0;
+    for (int i = 0; i < n; ++i) {
+        offset[i + 1] += offset[i];
+    }
+    ndx = new unsigned int[offset[n]];
+    vals = new double[offset[n]];
+    size_t next = 0;
+    for (int t = 0; t < threads; ++t) {
+        std::copy(info[t].ndx.begin(), info[t].ndx.end(), ndx + next);
+        std::copy(info[t].vals.begin(), info[t].vals.end(), vals + next);
+        next += info[t].ndx.size();
+    }
+
+    delete [] info;
+}
+
+KernelNeighbors::~KernelNeighbors() {
+    delete [] offset;
+    delete [] ndx;
+    delete [] vals;
+}
+
+double KernelNeighbors::value(int i, int j) const {
+    unsigned int const *first = neighbors(i), *last = first + count(i);
+    unsigned int const *p = std::lower_bound(first, last, (unsigned int)j);
+    return (p != last && *p == (unsigned int)j) ? vals[offset[i] + (p - first)] : 0.0;
+}
+
+double KernelNeighbors::rowSum(int i, unsigned int const *cols, size_t count) const {
+    unsigned int const *first = neighbors(i), *last = first + this->count(i);
+    double const *v = values(i);
+    unsigned int const *colsEnd = cols + count;
+
+    // step through the shorter list, searching ahead in the longer one
+    double s = 0.0;
+    if ((size_t)(last - first) <= count) {
+        unsigned int const *c = cols;
+        for (unsigned int const *p = first; p != last && c != colsEnd; ++p) {
+            c = std::lower_bound(c, colsEnd, *p);
+            if (c != colsEnd && *c == *p) {
+                s += v[p - first];
+                ++c;
+            }
+        }
+    } else {
+        unsigned int const *p = first;
+        for (unsigned int const *c = cols; c != colsEnd && p != last; ++c) {
+            p = std::lower_bound(p, last, *c);
+            if (p != last && *p == *c) {
+                s += v[p - first];
+                ++p;
+            }
+        }
+    }
+    return s;
+}
+
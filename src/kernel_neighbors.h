@@ -0,0 +1,65 @@
+#ifndef KERNEL_NEIGHBORS_H
+#define KERNEL_NEIGHBORS_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * KernelNeighbors holds a truncated kernel matrix: for each record, the
+ * records whose kernel value with it is at least a threshold, and those
+ * values; smaller values are taken to be zero. For a kernel that decays with
+ * distance (such as the gaussian kernel with a small bandwidth), these are
+ * the records within a radius, which are found once with a kd-tree, so the
+ * memory and the cost of kernel sums grow with the neighborhood sizes rather
+ * than n^2. The neighbors of each record are kept in index order, so a sum
+ * over a sorted list of records (such as a cluster's memberships) is a merge
+ * of the two lists.
+ */
+
+#include "dataset.h"
+#include <cstddef>
+
+class Kernel;
+
+class KernelNeighbors {
+    public:
+        // Find the neighbors of each record of x (whose squared norms are
+        // norms2) under kernel: the records within squared distance
+        // cutoffDist2 whose kernel value is at least threshold. Uses
+        // numThreads threads.
+        KernelNeighbors(Kernel const &kernel, Dataset const *x, double const *norms2,
+                double threshold, double cutoffDist2, int numThreads);
+        ~KernelNeighbors();
+
+        // The total number of neighbors (each record is its own neighbor).
+        size_t getNumPairs() const { return offset[n]; }
+
+        // The neighbors of record i, in index order, and their kernel values.
+        unsigned int const *neighbors(int i) const { return ndx + offset[i]; }
+        double const *values(int i) const { return vals + offset[i]; }
+        int count(int i) const { return (int)(offset[i + 1] - offset[i]); }
+
+        // The (truncated) kernel value between records i and j.
+        double value(int i, int j) const;
+
+        // The sum of the (truncated) kernel values between record i and the
+        // count records listed in cols, which must be in index order.
+        double rowSum(int i, unsigned int const *cols, size_t count) const;
+
+    private:
+        int n;
+
+        // The neighbors of record i are ndx[offset[i]] ... ndx[offset[i + 1]
+        // - 1], with kernel values in vals.
+        size_t *offset;
+        unsigned int *ndx;
+        double *vals;
+
+        // Disallow copies.
+        KernelNeighbors(KernelNeighbors const &);
+        KernelNeighbors const &operator=(KernelNeighbors const &);
+};
+
+#endif
+
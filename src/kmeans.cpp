@@ -6,11 +6,12 @@
 
 #include "kmeans.h"
 #include "general_functions.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
 Kmeans::Kmeans() : x(NULL), n(0), k(0), d(0), numThreads(0), converged(false),
-    clusterSize(NULL), centerMovement(NULL), assignment(NULL) {
+    clusterSize(NULL), centerMovement(NULL), seedDistances(NULL), assignment(NULL) {
     #ifdef COUNT_DISTANCES
     numDistances = 0;
     #endif
@@ -117,6 +118,121 @@ int Kmeans::run(int maxIterations) {
     return iterations;
 }
 
+struct SeedThreadInfo {
+    Kmeans *km;
+    Dataset const *x, *initialCenters;
+    std::pair<double, int> *nearest;
+    unsigned short *assignment;
+    int m, threadId, numThreads;
+    // pass 0 finds the nearest initial centers; pass 1 seeds the bounds
+    int pass;
+    #ifdef USE_THREADS
+    pthread_t pthread_id;
+    #endif
+};
+
+void *Kmeans::seed_runner(void *args) {
+    SeedThreadInfo *ti = (SeedThreadInfo *)args;
+    Dataset const &x = *ti->x;
+    Dataset const &c = *ti->initialCenters;
+    int startNdx = (int)((long long)x.n * ti->threadId / ti->numThreads);
+    int endNdx = (int)((long long)x.n * (ti->threadId + 1) / ti->numThreads);
+
+    if (ti->pass == 1) {
+        ti->km->seed_bounds(ti->nearest, ti->m, startNdx, endNdx);
+        return NULL;
+    }
+
+    // with the distances to all centers going to seedDistances, only the
+    // nearest is kept here
+    double *all = ti->km->seedDistances;
+    std::pair<double, int> *order = new std::pair<double, int>[c.n];
+    for (int i = startNdx; i < endNdx; ++i) {
+        double const *xp = x.data + i * x.d;
+        std::pair<double, int> *nearest = ti->nearest + (size_t)i * ti->m;
+        for (int j = 0; j < c.n; ++j) {
+            double d2 = distance2(xp, c.data + j * x.d, x.d);
+            order[j] = std::make_pair(d2, j);
+            if (all) {
+                all[(size_t)i * c.n + j] = sqrt(d2);
+            }
+        }
+        // ties go to the lowest index, as in assign()
+        if (ti->m == 1) {
+            *nearest = *std::min_element(order, order + c.n);
+        } else {
+            std::partial_sort(order, order + ti->m, order + c.n);
+            std::copy(order, order + ti->m, nearest);
+        }
+        ti->assignment[i] = nearest->second;
+    }
+    delete [] order;
+
+    return NULL;
+}
+
+void Kmeans::initialize(Dataset const *aX, Dataset const &initialCenters, unsigned short *assignmentOut, int aNumThreads) {
+    int m = std::max(1, std::min((int)initialCenters.n, numSeedCenters(initialCenters.n)));
+    std::pair<double, int> *nearest = new std::pair<double, int>[(size_t)aX->n * m];
+    if (seedsAllCenters()) {
+        seedDistances = new double[(size_t)aX->n * initialCenters.n];
+    }
+
+    #ifdef USE_THREADS
+    int threads = aNumThreads;
+    #else
+    int threads = 1;
+    #endif
+    SeedThreadInfo *info = new SeedThreadInfo[threads];
+    for (int t = 0; t < threads; ++t) {
+        info[t].km = this;
+        info[t].x = aX;
+        info[t].initialCenters = &initialCenters;
+        info[t].nearest = nearest;
+        info[t].assignment = assignmentOut;
+        info[t].m = m;
+        info[t].threadId = t;
+        info[t].numThreads = threads;
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) {
+            // this computes the means of the assignment
+            initialize(aX, initialCenters.n, assignmentOut, aNumThreads);
+
+            Dataset const *means = getCenters();
+            for (int j = 0; j < k; ++j) {
+                centerMovement[j] = 0.0;
+                if (means) {
+                    for (int dim = 0; dim < d; ++dim) {
+                        double diff = (*means)(j, dim) - initialCenters(j, dim);
+                        centerMovement[j] += diff * diff;
+                    }
+                }
+                centerMovement[j] = sqrt(centerMovement[j]);
+            }
+        }
+
+        #ifdef USE_THREADS
+        for (int t = 0; t < threads; ++t) {
+            info[t].pass = pass;
+            pthread_create(&info[t].pthread_id, NULL, Kmeans::seed_runner, &info[t]);
+        }
+        for (int t = 0; t < threads; ++t) {
+            pthread_join(info[t].pthread_id, NULL);
+        }
+        #else
+        info[0].pass = pass;
+        seed_runner(&info[0]);
+        #endif
+    }
+
+    delete [] info;
+    delete [] nearest;
+    delete [] seedDistances;
+    seedDistances = NULL;
+}
+
 double Kmeans::getSSE() const {
     double sse = 0.0;
     for (int i = 0; i < n; ++i) {
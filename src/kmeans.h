@@ -14,6 +14,7 @@
 #include "dataset.h"
 #include <limits>
 #include <string>
+#include <utility>
 #ifdef USE_THREADS
     #include <pthread.h>
 #endif
@@ -38,6 +39,16 @@ class Kmeans {
         // final assignment of clusters.
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
 
+        // Initialize the algorithm from initial centers, rather than from an
+        // initial assignment (replacing a call to assign() followed by the
+        // initialize() above). Each point is assigned to its closest initial
+        // center in one parallel pass, and algorithms that keep distance
+        // bounds seed them from the distances found in that pass, so that
+        // their first iteration need not recompute them. As above, the centers
+        // then start at the means of their assigned points, and assignmentOut
+        // (of length n) is used as initialAssignment is.
+        void initialize(Dataset const *aX, Dataset const &initialCenters, unsigned short *assignmentOut, int aNumThreads);
+
         // Free all memory being used by the object.
         virtual void free();
 
@@ -115,6 +126,13 @@ class Kmeans {
         // distance bounds (in subclasses that use them).
         double *centerMovement;
 
+        // While initializing from centers for an algorithm whose
+        // seedsAllCenters(), the distance (not squared) from each point i to
+        // each initial center j is seedDistances[i * k + j]. initialize() may
+        // take this array as its own, setting seedDistances to NULL; otherwise
+        // it is NULL.
+        double *seedDistances;
+
         // For each point in x, keep which cluster it is assigned to. By using a
         // short, we assume a limited number of clusters (fewer than 2^16).
         unsigned short *assignment;
@@ -126,6 +144,25 @@ class Kmeans {
         // Static entry method for pthread_create(). 
         static void *runner(void *args);
 
+        // How many of each point's nearest initial centers seed_bounds()
+        // needs, when initializing from aK initial centers.
+        virtual int numSeedCenters(int aK) const { return 1; }
+
+        // Whether seed_bounds() needs the distances to all initial centers.
+        // If so, the seeding pass writes them to seedDistances rather than
+        // sorting them into nearest.
+        virtual bool seedsAllCenters() const { return false; }
+
+        // Seed the bounds of points [startNdx, endNdx), after initialize(),
+        // from their m nearest initial centers: nearest[i * m + q] is the
+        // squared distance to, and index of, the (q+1)th nearest one. At this
+        // point centerMovement holds the distance from each initial center to
+        // the mean of its points (where the center now is).
+        virtual void seed_bounds(std::pair<double, int> const *nearest, int m, int startNdx, int endNdx) {}
+
+        // Static entry method for the threads of the seeding passes.
+        static void *seed_runner(void *args);
+
         // Assign point at xIndex to cluster newCluster, working within thread threadId.
         virtual void changeAssignment(int xIndex, int newCluster, int threadId);
 
@@ -0,0 +1,195 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "kmeans_model.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char const MODEL_MAGIC[8] = { 'F', 'K', 'M', 'M', 'O', 'D', 'L', '1' };
+static const size_t MODEL_HEADER_SIZE = 48;
+
+// The size of a section of the file, padded to a multiple of 8 bytes.
+static size_t padded(size_t bytes) {
+    return (bytes + 7) / 8 * 8;
+}
+
+KmeansModel::KmeansModel() : k(0), d(0), n(0), iterations(0), sse(0.0),
+    centerData(NULL), centerNorms(NULL), clusterSizes(NULL), assignment(NULL),
+    mapped(NULL), mappedLength(0), buffer(NULL) {}
+
+bool KmeansModel::save(std::string const &filename, Dataset const &centers,
+        unsigned short const *assignment, int n, int const *clusterSizes,
+        std::string const &algorithm, std::string const &config,
+        int iterations, double sse) {
+    int k = centers.n, d = centers.d;
+    if (assignment == NULL) {
+        n = 0;
+    }
+
+    char header[MODEL_HEADER_SIZE];
+    memset(header, 0, MODEL_HEADER_SIZE);
+    int32_t counts[4] = { k, d, n, iterations };
+    int32_t lengths[2] = { (int32_t)algorithm.size(), (int32_t)config.size() };
+    memcpy(header, MODEL_MAGIC, sizeof(MODEL_MAGIC));
+    memcpy(header + 8, counts, sizeof(counts));
+    memcpy(header + 24, &sse, sizeof(sse));
+    memcpy(header + 32, lengths, sizeof(lengths));
+
+    double *norms = new double[k];
+    for (int j = 0; j < k; ++j) {
+        norms[j] = 0.0;
+        for (int dim = 0; dim < d; ++dim) {
+            norms[j] += centers(j, dim) * centers(j, dim);
+        }
+        norms[j] = sqrt(norms[j]);
+    }
+
+    int32_t *sizes = new int32_t[k];
+    std::fill(sizes, sizes + k, 0);
+    if (assignment) {
+        for (int i = 0; i < n; ++i) {
+            if (assignment[i] < k) {
+                ++sizes[assignment[i]];
+            }
+        }
+    } else if (clusterSizes) {
+        std::copy(clusterSizes, clusterSizes + k, sizes);
+    }
+
+    char const zeros[8] = { 0 };
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    out.write(header, MODEL_HEADER_SIZE);
+    out.write(algorithm.data(), algorithm.size());
+    out.write(zeros, padded(algorithm.size()) - algorithm.size());
+    out.write(config.data(), config.size());
+    out.write(zeros, padded(config.size()) - config.size());
+    out.write((char const *)centers.data, (std::streamsize)k * d * sizeof(double));
+    out.write((char const *)norms, (std::streamsize)k * sizeof(double));
+    out.write((char const *)sizes, (std::streamsize)k * sizeof(int32_t));
+    out.write(zeros, padded(k * sizeof(int32_t)) - k * sizeof(int32_t));
+    if (n > 0) {
+        out.write((char const *)assignment, (std::streamsize)n * sizeof(unsigned short));
+    }
+
+    delete [] norms;
+    delete [] sizes;
+    return (bool)out;
+}
+
+bool KmeansModel::load(std::string const &filename, bool useMmap) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    char header[MODEL_HEADER_SIZE];
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < MODEL_HEADER_SIZE ||
+            pread(fd, header, MODEL_HEADER_SIZE, 0) != (ssize_t)MODEL_HEADER_SIZE ||
+            memcmp(header, MODEL_MAGIC, sizeof(MODEL_MAGIC)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    int32_t counts[4], lengths[2];
+    memcpy(counts, header + 8, sizeof(counts));
+    memcpy(&sse, header + 24, sizeof(sse));
+    memcpy(lengths, header + 32, sizeof(lengths));
+    k = counts[0];
+    d = counts[1];
+    n = counts[2];
+    iterations = counts[3];
+
+    // check that the sections fit in the file
+    size_t fileLength = info.st_size;
+    bool valid = k >= 1 && d >= 1 && n >= 0 && lengths[0] >= 0 && lengths[1] >= 0;
+    size_t textLength = valid ? padded(lengths[0]) + padded(lengths[1]) : 0;
+    size_t length = MODEL_HEADER_SIZE + textLength + (size_t)k * (d + 1) * sizeof(double) +
+        padded((size_t)k * sizeof(int32_t)) + (size_t)n * sizeof(unsigned short);
+    if (! valid || length > fileLength) {
+        ::close(fd);
+        close();
+        return false;
+    }
+
+    char const *base = NULL;
+    if (useMmap) {
+        mapped = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            mapped = NULL;
+        } else {
+            mappedLength = length;
+            base = (char const *)mapped;
+        }
+    }
+    if (base == NULL) {
+        // read the file (into storage aligned for doubles)
+        buffer = new double[(length + sizeof(double) - 1) / sizeof(double)];
+        size_t done = 0;
+        while (done < length) {
+            ssize_t got = pread(fd, (char *)buffer + done, length - done, done);
+            if (got <= 0) {
+                break;
+            }
+            done += got;
+        }
+        if (done < length) {
+            ::close(fd);
+            close();
+            return false;
+        }
+        base = (char const *)buffer;
+    }
+    ::close(fd);
+
+    char const *p = base + MODEL_HEADER_SIZE;
+    algorithm.assign(p, lengths[0]);
+    p += padded(lengths[0]);
+    config.assign(p, lengths[1]);
+    p += padded(lengths[1]);
+    centerData = (double const *)p;
+    p += (size_t)k * d * sizeof(double);
+    centerNorms = (double const *)p;
+    p += (size_t)k * sizeof(double);
+    clusterSizes = (int32_t const *)p;
+    p += padded((size_t)k * sizeof(int32_t));
+    assignment = (n > 0) ? (unsigned short const *)p : NULL;
+
+    return true;
+}
+
+void KmeansModel::close() {
+    if (mapped) {
+        munmap(mapped, mappedLength);
+    }
+    delete [] buffer;
+    mapped = NULL;
+    mappedLength = 0;
+    buffer = NULL;
+    centerData = centerNorms = NULL;
+    clusterSizes = NULL;
+    assignment = NULL;
+    k = d = n = iterations = 0;
+    sse = 0.0;
+    algorithm.clear();
+    config.clear();
+}
+
+Dataset *KmeansModel::getCenters() const {
+    if (centerData == NULL) {
+        return NULL;
+    }
+    Dataset *centers = new Dataset(k, d);
+    std::copy(centerData, centerData + k * d, centers->data);
+    return centers;
+}
@@ -0,0 +1,92 @@
+#ifndef KMEANS_MODEL_H
+#define KMEANS_MODEL_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * A KmeansModel is a trained k-means model stored in a compact binary file,
+ * which keeps the centers at full precision and can be memory-mapped, so that
+ * serving processes and warm-started runs can load it quickly. The file holds,
+ * in native byte order:
+ *  - the 8 bytes "FKMMODL1"; k, d, n (0 if no assignment is stored) and the
+ *    number of iterations as 32-bit integers; the SSE as a double; and the
+ *    lengths of the algorithm name and configuration text as 32-bit integers,
+ *    padded to 48 bytes;
+ *  - the algorithm name and the configuration text (e.g. "k=10 threads=4"),
+ *    each padded to a multiple of 8 bytes;
+ *  - the k * d centers, in record-major order, and the k center norms, as
+ *    doubles;
+ *  - the k cluster sizes as 32-bit integers, padded to a multiple of 8 bytes;
+ *  - optionally, the assignment of n records, as unsigned shorts.
+ * Every array starts at a multiple of 8 bytes, so a mapped file is used in
+ * place.
+ */
+
+#include "dataset.h"
+#include <stdint.h>
+#include <string>
+
+class KmeansModel {
+    public:
+        KmeansModel();
+        ~KmeansModel() { close(); }
+
+        // Write a model with the given centers to filename. If assignment is
+        // not NULL, the assignment of the n records is stored, and the cluster
+        // sizes are counted from it; otherwise clusterSizes gives them (or
+        // they are stored as 0, if it is NULL too). Returns false on failure.
+        static bool save(std::string const &filename, Dataset const &centers,
+                unsigned short const *assignment, int n, int const *clusterSizes,
+                std::string const &algorithm, std::string const &config,
+                int iterations, double sse);
+
+        // Load the model in filename, memory-mapping it if useMmap is true
+        // (otherwise it is read into memory). Returns false if the file cannot
+        // be read or is not a valid model.
+        bool load(std::string const &filename, bool useMmap = true);
+        void close();
+
+        int getK() const { return k; }
+        int getD() const { return d; }
+        int getIterations() const { return iterations; }
+        double getSSE() const { return sse; }
+        std::string const &getAlgorithm() const { return algorithm; }
+        std::string const &getConfig() const { return config; }
+
+        // The k * d centers, their norms, and the cluster sizes, which point
+        // into the loaded file.
+        double const *getCenterData() const { return centerData; }
+        double const *getCenterNorms() const { return centerNorms; }
+        int32_t const *getClusterSizes() const { return clusterSizes; }
+
+        // A copy of the centers, which the caller must delete.
+        Dataset *getCenters() const;
+
+        // The stored assignment of getN() records, or NULL if there is none.
+        int getN() const { return n; }
+        unsigned short const *getAssignment() const { return assignment; }
+
+    private:
+        int k, d, n, iterations;
+        double sse;
+        std::string algorithm, config;
+
+        double const *centerData;
+        double const *centerNorms;
+        int32_t const *clusterSizes;
+        unsigned short const *assignment;
+
+        // The file contents: either mapped (mappedLength bytes) or read into
+        // buffer.
+        void *mapped;
+        size_t mappedLength;
+        double *buffer;
+
+        // Disallow copies.
+        KmeansModel(KmeansModel const &);
+        KmeansModel const &operator=(KmeansModel const &);
+};
+
+#endif
@@ -0,0 +1,165 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "minibatch_kmeans.h"
+#include "general_functions.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+MiniBatchKmeans::MiniBatchKmeans(int aBatchSize, int aPatience) :
+    batchSize(aBatchSize), patience(aPatience), batch(NULL), batchData(NULL),
+    batchAssignment(NULL), batchDist2(NULL), tiles(NULL), centerCount(NULL),
+    ewaObjective(0.0), bestEwaObjective(0.0), batchesWithoutImprovement(0) {
+    if (batchSize < 1) {
+        batchSize = 1;
+    }
+}
+
+void MiniBatchKmeans::free() {
+    OriginalSpaceKmeans::free();
+    delete [] batch;
+    delete batchData;
+    delete [] batchAssignment;
+    delete [] batchDist2;
+    delete [] tiles;
+    delete [] centerCount;
+    batch = NULL;
+    batchData = NULL;
+    batchAssignment = NULL;
+    batchDist2 = NULL;
+    tiles = NULL;
+    centerCount = NULL;
+}
+
+void MiniBatchKmeans::initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads) {
+    OriginalSpaceKmeans::initialize(aX, aK, initialAssignment, aNumThreads);
+
+    batch = new int[batchSize];
+    batchData = new Dataset(batchSize, d, false);
+    batchAssignment = new unsigned short[batchSize];
+    batchDist2 = new double[batchSize];
+    tiles = new double[assignTilesSize(k, d)];
+    centerCount = new long long[k];
+
+    std::fill(centerCount, centerCount + k, 0);
+    ewaObjective = bestEwaObjective = std::numeric_limits<double>::max();
+    batchesWithoutImprovement = 0;
+}
+
+/* Each iteration processes one batch: thread 0 samples it (and lays out the
+ * centers for assignRange()), all threads copy and assign a share of it, and
+ * then each thread moves its share of the centers (centers
+ * j with j % numThreads == threadId), visiting the batch points in order so
+ * the result is the same for any number of threads.
+ *
+ * Parameters:
+ *   - threadId: the index of the thread that is running
+ *   - maxIterations: a bound on the number of batches to process (with no
+ *     bound, MAX_EPOCHS passes' worth)
+ *
+ * Return value: the number of batches processed
+ */
+int MiniBatchKmeans::runThread(int threadId, int maxIterations) {
+    int iterations = 0;
+
+    if (maxIterations == std::numeric_limits<int>::max()) {
+        long long maxBatches = ((long long)MAX_EPOCHS * n + batchSize - 1) / batchSize;
+        maxIterations = (int)std::min(maxBatches, (long long)maxIterations);
+    }
+
+    int batchStart = batchSize * threadId / numThreads;
+    int batchEnd = batchSize * (threadId + 1) / numThreads;
+
+    while ((iterations < maxIterations) && ! converged) {
+        ++iterations;
+
+        if (threadId == 0) {
+            for (int b = 0; b < batchSize; ++b) {
+                batch[b] = rand() % n;
+            }
+            layoutAssignTiles(*centers, tiles);
+        }
+        synchronizeAllThreads();
+
+        // copy this thread's share of the batch, and assign it
+        for (int b = batchStart; b < batchEnd; ++b) {
+            std::copy(x->data + batch[b] * d, x->data + (batch[b] + 1) * d, batchData->data + b * d);
+        }
+        assignRange(*batchData, k, tiles, batchStart, batchEnd, batchAssignment + batchStart, batchDist2 + batchStart);
+        synchronizeAllThreads();
+
+        for (int b = 0; b < batchSize; ++b) {
+            int j = batchAssignment[b];
+            if (j % numThreads != threadId) {
+                continue;
+            }
+            // c = (1 - eta) c + eta x, with eta = 1 / count
+            double eta = 1.0 / (double)(++centerCount[j]);
+            double *c = centers->data + j * d;
+            double const *xp = x->data + batch[b] * d;
+            for (int dim = 0; dim < d; ++dim) {
+                c[dim] += eta * (xp[dim] - c[dim]);
+            }
+        }
+
+        // the first batch measures the initial centers, which the learning
+        // rates then discard, so it does not count toward the objective
+        if (threadId == 0 && iterations > 1) {
+            update_objective();
+        }
+        synchronizeAllThreads();
+    }
+
+    // assign every point to its closest final center
+    int startNdx = start(threadId);
+    int endNdx = end(threadId);
+    if (threadId == 0) {
+        layoutAssignTiles(*centers, tiles);
+    }
+    synchronizeAllThreads();
+    unsigned short *closest = new unsigned short[endNdx - startNdx];
+    assignRange(*x, k, tiles, startNdx, endNdx, closest);
+    for (int i = startNdx; i < endNdx; ++i) {
+        if (assignment[i] != closest[i - startNdx]) {
+            changeAssignment(i, closest[i - startNdx], threadId);
+        }
+    }
+    delete [] closest;
+
+    verifyAssignment(iterations, startNdx, endNdx);
+    synchronizeAllThreads();
+
+    return iterations;
+}
+
+/* Fold the latest batch into the EWA objective, weighting it by the fraction
+ * of the data a batch represents (as in scikit-learn), and stop once the EWA
+ * has gone "patience" batches without improving.
+ */
+void MiniBatchKmeans::update_objective() {
+    double objective = 0.0;
+    for (int b = 0; b < batchSize; ++b) {
+        objective += batchDist2[b];
+    }
+    objective /= batchSize;
+
+    if (ewaObjective == std::numeric_limits<double>::max()) {
+        ewaObjective = objective;
+    } else {
+        double alpha = std::min(1.0, 2.0 * batchSize / (n + 1.0));
+        ewaObjective = ewaObjective * (1.0 - alpha) + objective * alpha;
+    }
+
+    if (ewaObjective < bestEwaObjective) {
+        bestEwaObjective = ewaObjective;
+        batchesWithoutImprovement = 0;
+    } else {
+        ++batchesWithoutImprovement;
+    }
+
+    converged = (patience > 0) && (batchesWithoutImprovement >= patience);
+}
@@ -0,0 +1,77 @@
+#ifndef MINIBATCH_KMEANS_H
+#define MINIBATCH_KMEANS_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * MiniBatchKmeans implements Sculley's mini-batch k-means. Each iteration
+ * samples a small batch of points (with replacement), assigns them to their
+ * closest centers, and moves each center toward its batch points with a
+ * per-center learning rate of 1 / (number of points it has absorbed so far).
+ * It stops after maxIterations batches, or earlier once an exponentially
+ * weighted average (EWA) of the batch objective has stopped improving. Without
+ * a limit on the iterations, it processes at most MAX_EPOCHS passes' worth of
+ * batches (n / batchSize batches per pass). A final full pass then assigns
+ * every point to its closest center.
+ *
+ * Unlike the other algorithms, this does not converge to the same solution as
+ * Lloyd's algorithm; it trades accuracy for speed on very large datasets. The
+ * result does not depend on the number of threads.
+ */
+
+#include "original_space_kmeans.h"
+
+class MiniBatchKmeans : public OriginalSpaceKmeans {
+    public:
+        // Use batches of batchSize points, and stop when the EWA objective has
+        // not improved for "patience" consecutive batches (0 means never stop
+        // early).
+        MiniBatchKmeans(int aBatchSize = 1000, int aPatience = 10);
+        virtual ~MiniBatchKmeans() { free(); }
+        virtual void free();
+        using Kmeans::initialize;
+        virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
+        virtual std::string getName() const { return "minibatch"; }
+
+        // The most passes' worth of batches in a run without a limit on the
+        // iterations, so that runs with a patience of 0 end.
+        static int const MAX_EPOCHS = 100;
+
+        // The EWA of the batch objective (mean squared distance of a batch
+        // point to its closest center) after the last batch.
+        double getEwaObjective() const { return ewaObjective; }
+
+    protected:
+        virtual int runThread(int threadId, int maxIterations);
+
+        // Update the EWA objective with the latest batch, and decide whether
+        // to stop.
+        void update_objective();
+
+        int batchSize, patience;
+
+        // The sampled points of the current batch (their indices, and a copy
+        // of the points), their closest centers, and the squared distances to
+        // those centers.
+        int *batch;
+        Dataset *batchData;
+        unsigned short *batchAssignment;
+        double *batchDist2;
+
+        // The centers, laid out for assignRange() (which finds the closest
+        // centers as assign() does).
+        double *tiles;
+
+        // How many batch points each center has absorbed; the learning rate
+        // of center j is 1 / centerCount[j].
+        long long *centerCount;
+
+        // The EWA of the batch objective, its best value so far, and the
+        // number of batches since that best value.
+        double ewaObjective, bestEwaObjective;
+        int batchesWithoutImprovement;
+};
+
+#endif
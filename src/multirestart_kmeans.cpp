@@ -0,0 +1,405 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "multirestart_kmeans.h"
+#include "general_functions.h"
+#include <algorithm>
+#include <cmath>
+
+MultiRestartKmeans::MultiRestartKmeans(double aAbandonMargin, int aCheckInterval) :
+    x(NULL), n(0), k(0), d(0), runs(0), numThreads(0),
+    abandonMargin(aAbandonMargin), checkInterval(std::max(1, aCheckInterval)),
+    centers(NULL), sumNewCenters(NULL), clusterSize(NULL), centerMovement(NULL),
+    s(NULL), furthest(NULL), secondFurthest(NULL), assignment(NULL),
+    upper(NULL), lower(NULL), running(NULL), abandoned(NULL), iterations(NULL),
+    threadSSE(NULL), sse(NULL), anyRunning(false) {}
+
+void MultiRestartKmeans::free() {
+    for (int r = 0; r < runs; ++r) {
+        delete centers[r];
+    }
+    for (int t = 0; t < numThreads; ++t) {
+        delete [] sumNewCenters[t];
+        delete [] clusterSize[t];
+        delete [] threadSSE[t];
+    }
+    delete [] centers;
+    delete [] sumNewCenters;
+    delete [] clusterSize;
+    delete [] threadSSE;
+    delete [] centerMovement;
+    delete [] s;
+    delete [] furthest;
+    delete [] secondFurthest;
+    delete [] assignment;
+    delete [] upper;
+    delete [] lower;
+    delete [] running;
+    delete [] abandoned;
+    delete [] iterations;
+    delete [] sse;
+    centers = NULL;
+    sumNewCenters = NULL;
+    clusterSize = NULL;
+    threadSSE = NULL;
+    centerMovement = s = secondFurthest = NULL;
+    furthest = NULL;
+    assignment = NULL;
+    upper = lower = NULL;
+    running = abandoned = NULL;
+    iterations = NULL;
+    sse = NULL;
+    x = NULL;
+    n = k = d = runs = numThreads = 0;
+}
+
+void MultiRestartKmeans::initialize(Dataset const *aX, Dataset const * const *initialCenters, int aRuns, int aNumThreads) {
+    free();
+
+    x = aX;
+    n = x->n;
+    d = x->d;
+    runs = aRuns;
+    k = initialCenters[0]->n;
+    #ifdef USE_THREADS
+    numThreads = aNumThreads;
+    #else
+    numThreads = 1;
+    #endif
+
+    centers = new Dataset *[runs];
+    for (int r = 0; r < runs; ++r) {
+        centers[r] = new Dataset(*initialCenters[r]);
+    }
+    centerMovement = new double[runs * k];
+    s = new double[runs * k];
+    std::fill(s, s + runs * k, 0.0);
+    furthest = new int[runs];
+    secondFurthest = new double[runs];
+
+    sumNewCenters = new double *[numThreads];
+    clusterSize = new int *[numThreads];
+    threadSSE = new double *[numThreads];
+    for (int t = 0; t < numThreads; ++t) {
+        sumNewCenters[t] = new double[(size_t)runs * k * d];
+        clusterSize[t] = new int[runs * k];
+        threadSSE[t] = new double[runs];
+        std::fill(sumNewCenters[t], sumNewCenters[t] + (size_t)runs * k * d, 0.0);
+        std::fill(clusterSize[t], clusterSize[t] + runs * k, 0);
+    }
+
+    // no point is assigned yet, which forces the first pass to look at all
+    // centers for every point
+    size_t numBounds = (size_t)n * runs;
+    assignment = new unsigned short[numBounds];
+    upper = new double[numBounds];
+    lower = new double[numBounds];
+    std::fill(assignment, assignment + numBounds, k);
+    std::fill(upper, upper + numBounds, std::numeric_limits<double>::max());
+    std::fill(lower, lower + numBounds, 0.0);
+
+    running = new bool[runs];
+    abandoned = new bool[runs];
+    iterations = new int[runs];
+    sse = new double[runs];
+    std::fill(running, running + runs, true);
+    std::fill(abandoned, abandoned + runs, false);
+    std::fill(iterations, iterations + runs, 0);
+    std::fill(sse, sse + runs, 0.0);
+    anyRunning = runs > 0;
+}
+
+#ifdef USE_THREADS
+struct MultiRestartThreadInfo {
+    MultiRestartKmeans *km;
+    int threadId, maxIterations, numIterations;
+    pthread_t pthread_id;
+};
+#endif
+
+void *MultiRestartKmeans::runner(void *args) {
+    #ifdef USE_THREADS
+    MultiRestartThreadInfo *ti = (MultiRestartThreadInfo *)args;
+    ti->numIterations = ti->km->runThread(ti->threadId, ti->maxIterations);
+    #endif
+    return NULL;
+}
+
+int MultiRestartKmeans::run(int maxIterations) {
+    int numIterations = 0;
+
+    #ifdef USE_THREADS
+    {
+        pthread_barrier_init(&barrier, NULL, numThreads);
+        MultiRestartThreadInfo *info = new MultiRestartThreadInfo[numThreads];
+        for (int t = 0; t < numThreads; ++t) {
+            info[t].km = this;
+            info[t].threadId = t;
+            info[t].maxIterations = maxIterations;
+            pthread_create(&info[t].pthread_id, NULL, MultiRestartKmeans::runner, &info[t]);
+        }
+        for (int t = 0; t < numThreads; ++t) {
+            pthread_join(info[t].pthread_id, NULL);
+        }
+        numIterations = info[0].numIterations;
+        delete [] info;
+        pthread_barrier_destroy(&barrier);
+    }
+    #else
+    {
+        numIterations = runThread(0, maxIterations);
+    }
+    #endif
+
+    return numIterations;
+}
+
+/* Each iteration is one pass over the data, in which all threads assign their
+ * share of the points for every running run; then thread 0 abandons runs (on
+ * check iterations) and moves the centers, and all threads update the bounds.
+ * A final pass measures the SSE of the runs that were not abandoned.
+ *
+ * Parameters:
+ *   - threadId: the index of the thread that is running
+ *   - maxIterations: a bound on the number of iterations to perform
+ *
+ * Return value: the number of iterations performed (by the longest run)
+ */
+int MultiRestartKmeans::runThread(int threadId, int maxIterations) {
+    int iteration = 0;
+
+    int startNdx = (int)((long long)n * threadId / numThreads);
+    int endNdx = (int)((long long)n * (threadId + 1) / numThreads);
+
+    // pass 0 assigns the points to the initial centers (as assign() does
+    // before the other algorithms start), and is not counted as an iteration
+    for (int pass = 0; anyRunning && pass <= maxIterations; ++pass) {
+        iteration = pass;
+
+        bool measureSSE = (abandonMargin >= 0.0) && (pass > 0) && (pass % checkInterval == 0);
+        assign_points(threadId, startNdx, endNdx, measureSSE);
+        synchronizeAllThreads();
+
+        if (threadId == 0) {
+            if (measureSSE) {
+                total_sse(running);
+                double best = std::numeric_limits<double>::max();
+                for (int r = 0; r < runs; ++r) {
+                    if (running[r]) {
+                        best = std::min(best, sse[r]);
+                    }
+                }
+                for (int r = 0; r < runs; ++r) {
+                    if (running[r] && sse[r] > (1.0 + abandonMargin) * best) {
+                        running[r] = false;
+                        abandoned[r] = true;
+                        iterations[r] = pass;
+                    }
+                }
+            }
+
+            anyRunning = false;
+            for (int r = 0; r < runs; ++r) {
+                if (running[r]) {
+                    iterations[r] = pass;
+                    running[r] = move_centers(r);
+                    anyRunning = anyRunning || running[r];
+                }
+            }
+        }
+        synchronizeAllThreads();
+
+        update_bounds(startNdx, endNdx);
+        synchronizeAllThreads();
+    }
+
+    measure_sse(threadId, startNdx, endNdx);
+    synchronizeAllThreads();
+
+    if (threadId == 0) {
+        bool *finished = new bool[runs];
+        for (int r = 0; r < runs; ++r) {
+            finished[r] = ! abandoned[r];
+        }
+        total_sse(finished);
+        delete [] finished;
+    }
+
+    return iteration;
+}
+
+void MultiRestartKmeans::assign_points(int threadId, int startNdx, int endNdx, bool measureSSE) {
+    if (measureSSE) {
+        std::fill(threadSSE[threadId], threadSSE[threadId] + runs, 0.0);
+    }
+
+    for (int i = startNdx; i < endNdx; ++i) {
+        double const *xp = x->data + i * d;
+
+        for (int r = 0; r < runs; ++r) {
+            if (! running[r]) {
+                continue;
+            }
+
+            size_t ir = (size_t)i * runs + r;
+            unsigned short closest = assignment[ir];
+            double const *c = centers[r]->data;
+            double const *sr = s + r * k;
+            // whether upper[ir] is the exact distance to the closest center
+            bool exact = false;
+
+            if (closest != k) {
+                // Hamerly's tests, as in HamerlyKmeans
+                double bound = std::max(sr[closest], lower[ir]);
+                if (upper[ir] > bound) {
+                    upper[ir] = sqrt(distance2(xp, c + closest * d, d));
+                    exact = true;
+                }
+                if (upper[ir] <= bound) {
+                    if (measureSSE) {
+                        if (! exact) {
+                            upper[ir] = sqrt(distance2(xp, c + closest * d, d));
+                        }
+                        threadSSE[threadId][r] += upper[ir] * upper[ir];
+                    }
+                    continue;
+                }
+            }
+
+            // look at all centers, taking the lowest index on ties (as
+            // Lloyd's algorithm does)
+            double closestDist2 = std::numeric_limits<double>::max();
+            double secondDist2 = std::numeric_limits<double>::max();
+            closest = 0;
+            for (int j = 0; j < k; ++j) {
+                double d2 = distance2(xp, c + j * d, d);
+                if (d2 < closestDist2) {
+                    secondDist2 = closestDist2;
+                    closestDist2 = d2;
+                    closest = j;
+                } else if (d2 < secondDist2) {
+                    secondDist2 = d2;
+                }
+            }
+
+            upper[ir] = sqrt(closestDist2);
+            lower[ir] = sqrt(secondDist2);
+            if (measureSSE) {
+                threadSSE[threadId][r] += closestDist2;
+            }
+
+            if (assignment[ir] != closest) {
+                double *sums = sumNewCenters[threadId] + (size_t)r * k * d;
+                int *sizes = clusterSize[threadId] + r * k;
+                if (assignment[ir] != k) {
+                    --sizes[assignment[ir]];
+                    subVectors(sums + assignment[ir] * d, xp, d);
+                }
+                ++sizes[closest];
+                addVectors(sums + closest * d, xp, d);
+                assignment[ir] = closest;
+            }
+        }
+    }
+}
+
+bool MultiRestartKmeans::move_centers(int r) {
+    bool moved = false;
+    double *movement = centerMovement + r * k;
+    Dataset &c = *centers[r];
+
+    for (int j = 0; j < k; ++j) {
+        movement[j] = 0.0;
+        int totalClusterSize = 0;
+        for (int t = 0; t < numThreads; ++t) {
+            totalClusterSize += clusterSize[t][r * k + j];
+        }
+        if (totalClusterSize > 0) {
+            for (int dim = 0; dim < d; ++dim) {
+                double z = 0.0;
+                for (int t = 0; t < numThreads; ++t) {
+                    z += sumNewCenters[t][((size_t)r * k + j) * d + dim];
+                }
+                z /= totalClusterSize;
+                movement[j] += (z - c(j, dim)) * (z - c(j, dim));
+                c(j, dim) = z;
+            }
+        }
+        movement[j] = sqrt(movement[j]);
+        moved = moved || (movement[j] > 0.0);
+    }
+
+    double *sr = s + r * k;
+    for (int c1 = 0; c1 < k; ++c1) {
+        sr[c1] = std::numeric_limits<double>::max();
+        for (int c2 = 0; c2 < k; ++c2) {
+            if (c2 != c1) {
+                sr[c1] = std::min(sr[c1], distance2(c.data + c1 * d, c.data + c2 * d, d));
+            }
+        }
+        sr[c1] = sqrt(sr[c1]) / 2.0;
+    }
+
+    // the lower bound shrinks by the furthest movement of any center other
+    // than the assigned one
+    furthest[r] = (int)(std::max_element(movement, movement + k) - movement);
+    secondFurthest[r] = 0.0;
+    for (int j = 0; j < k; ++j) {
+        if (j != furthest[r]) {
+            secondFurthest[r] = std::max(secondFurthest[r], movement[j]);
+        }
+    }
+
+    return moved;
+}
+
+void MultiRestartKmeans::update_bounds(int startNdx, int endNdx) {
+    for (int i = startNdx; i < endNdx; ++i) {
+        for (int r = 0; r < runs; ++r) {
+            if (! running[r]) {
+                continue;
+            }
+            size_t ir = (size_t)i * runs + r;
+            unsigned short a = assignment[ir];
+            double const *movement = centerMovement + r * k;
+            upper[ir] += movement[a];
+            lower[ir] -= (a == furthest[r]) ? secondFurthest[r] : movement[furthest[r]];
+        }
+    }
+}
+
+void MultiRestartKmeans::measure_sse(int threadId, int startNdx, int endNdx) {
+    std::fill(threadSSE[threadId], threadSSE[threadId] + runs, 0.0);
+    for (int i = startNdx; i < endNdx; ++i) {
+        double const *xp = x->data + i * d;
+        for (int r = 0; r < runs; ++r) {
+            if (! abandoned[r] && assignment[(size_t)i * runs + r] != k) {
+                threadSSE[threadId][r] += distance2(xp, centers[r]->data + assignment[(size_t)i * runs + r] * d, d);
+            }
+        }
+    }
+}
+
+void MultiRestartKmeans::total_sse(bool const *which) {
+    for (int r = 0; r < runs; ++r) {
+        if (which[r]) {
+            sse[r] = 0.0;
+            for (int t = 0; t < numThreads; ++t) {
+                sse[r] += threadSSE[t][r];
+            }
+        }
+    }
+}
+
+int MultiRestartKmeans::getBestRun() const {
+    int best = -1;
+    for (int r = 0; r < runs; ++r) {
+        if (! abandoned[r] && (best < 0 || sse[r] < sse[best])) {
+            best = r;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,142 @@
+#ifndef MULTIRESTART_KMEANS_H
+#define MULTIRESTART_KMEANS_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * MultiRestartKmeans runs several restarts of k-means (each with Hamerly's
+ * bounds, from its own initial centers) in lockstep. Each iteration makes one
+ * pass over the data, and each point is loaded once and then checked against
+ * the bounds and centers of every run, so the restarts share the memory
+ * bandwidth of a single run. Each run performs the same iterations as Lloyd's
+ * algorithm would from its initial centers.
+ *
+ * Every checkInterval iterations, the pass also computes each run's exact SSE,
+ * and runs whose SSE is more than (1 + abandonMargin) times the best are
+ * abandoned. A negative margin never abandons a run.
+ *
+ * Like StreamingKmeans, this does not derive from Kmeans (which has a single
+ * set of centers), but provides the same kind of interface.
+ */
+
+#include "dataset.h"
+#include <limits>
+#include <string>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
+
+class MultiRestartKmeans {
+    public:
+        MultiRestartKmeans(double aAbandonMargin = 0.1, int aCheckInterval = 5);
+        ~MultiRestartKmeans() { free(); }
+
+        // Prepare to cluster x (which must outlive this object) with one run
+        // for each of the runs sets of initial centers, which all have the
+        // same number of centers.
+        void initialize(Dataset const *aX, Dataset const * const *initialCenters, int aRuns, int aNumThreads);
+        void free();
+
+        // Run until every run converges or is abandoned (or for maxIterations
+        // iterations), and return the number of iterations performed. Each
+        // iteration is one pass over the data, after an initial pass that
+        // assigns the points to the initial centers.
+        int run(int maxIterations = std::numeric_limits<int>::max());
+
+        int getRuns() const { return runs; }
+
+        // The run with the lowest SSE among those not abandoned.
+        int getBestRun() const;
+
+        // The final SSE of run r (or its last measured SSE, if abandoned), and
+        // the number of iterations it performed.
+        double getSSE(int r) const { return sse[r]; }
+        int getIterations(int r) const { return iterations[r]; }
+        bool isAbandoned(int r) const { return abandoned[r]; }
+
+        Dataset const *getCenters(int r) const { return centers[r]; }
+        int getAssignment(int r, int xIndex) const { return assignment[(size_t)xIndex * runs + r]; }
+
+        std::string getName() const { return "multirestart"; }
+
+    private:
+        // This is where each thread does its work.
+        int runThread(int threadId, int maxIterations);
+        static void *runner(void *args);
+
+        // Assign points [startNdx, endNdx) for every running run; if
+        // measureSSE, also add their exact SSE to threadSSE[threadId].
+        void assign_points(int threadId, int startNdx, int endNdx, bool measureSSE);
+
+        // Move the centers of run r to the means of their points, and compute
+        // s and how far the centers moved. Returns whether the centers moved.
+        bool move_centers(int r);
+
+        // Update the bounds of points [startNdx, endNdx) after the centers of
+        // the running runs have moved.
+        void update_bounds(int startNdx, int endNdx);
+
+        // Add the exact SSE of points [startNdx, endNdx) for every run that
+        // was not abandoned to threadSSE[threadId].
+        void measure_sse(int threadId, int startNdx, int endNdx);
+
+        // Total the SSE measured by the threads (for the given runs).
+        void total_sse(bool const *which);
+
+        void synchronizeAllThreads() {
+            #ifdef USE_THREADS
+            pthread_barrier_wait(&barrier);
+            #endif
+        }
+
+        Dataset const *x;
+        int n, k, d, runs, numThreads;
+        double abandonMargin;
+        int checkInterval;
+
+        // The centers of each run.
+        Dataset **centers;
+
+        // For each thread, the sum and count of the points assigned to each
+        // center of each run (indexed by r * k + j).
+        double **sumNewCenters;
+        int **clusterSize;
+
+        // For each run, how far each center moved in the last iteration, and
+        // half the distance from each center to its closest other center
+        // (indexed by r * k + j); and the furthest and second-furthest
+        // movement.
+        double *centerMovement;
+        double *s;
+        int *furthest;
+        double *secondFurthest;
+
+        // Each point's assignment (k if not yet assigned) and bounds for each
+        // run, indexed by i * runs + r so that one point's data for all runs
+        // is together.
+        unsigned short *assignment;
+        double *upper, *lower;
+
+        // Whether each run is still iterating, and whether it was abandoned;
+        // the number of iterations of each run; each thread's partial SSE for
+        // each run, and each run's SSE.
+        bool *running, *abandoned;
+        int *iterations;
+        double **threadSSE;
+        double *sse;
+
+        // Whether any run is still iterating.
+        bool anyRunning;
+
+        #ifdef USE_THREADS
+        pthread_barrier_t barrier;
+        #endif
+
+        // Disallow copies.
+        MultiRestartKmeans(MultiRestartKmeans const &);
+        MultiRestartKmeans const &operator=(MultiRestartKmeans const &);
+};
+
+#endif
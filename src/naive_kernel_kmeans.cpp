@@ -20,7 +20,7 @@ int NaiveKernelKmeans::runThread(int threadId, int maxIterations) {
         bool membershipChanged = false;
 
         // precompute the (kernelized) inner product of each center with itself
-        computeMemberships(threadId, &memberships, &cc);
+        updateClusterStatistics(threadId, false);
 
         // we have converged... until we find out we haven't
         if (threadId == 0) {
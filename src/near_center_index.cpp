@@ -0,0 +1,237 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "near_center_index.h"
+#include "general_functions.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Use the kd-tree up to this dimension, and groups above it.
+static const int MAX_KD_TREE_DIMENSION = 12;
+
+// Rebuild the groups once any group's radius has grown by more than this
+// fraction of the average group radius.
+static const double MAX_GROUP_GROWTH = 0.5;
+
+NearCenterIndex::NearCenterIndex() : centers(NULL), k(0), d(0), numThreads(0),
+    useKdTree(false), tree(NULL), numGroups(0), anchors(NULL),
+    groupRadius(NULL), groupGrowth(NULL), groupStart(NULL), groupMembers(NULL),
+    groupOrder(NULL) {
+    #ifdef COUNT_DISTANCES
+    numDistances = 0;
+    #endif
+}
+
+void NearCenterIndex::free() {
+    for (int t = 0; t < numThreads && groupOrder; ++t) {
+        delete [] groupOrder[t];
+    }
+    delete [] groupOrder;
+    delete tree;
+    delete anchors;
+    delete [] groupRadius;
+    delete [] groupGrowth;
+    delete [] groupStart;
+    delete [] groupMembers;
+    groupOrder = NULL;
+    tree = NULL;
+    anchors = NULL;
+    groupRadius = groupGrowth = NULL;
+    groupStart = groupMembers = NULL;
+    centers = NULL;
+    k = d = numThreads = numGroups = 0;
+}
+
+void NearCenterIndex::initialize(Dataset const *aCenters, int aNumThreads) {
+    free();
+
+    centers = aCenters;
+    k = centers->n;
+    d = centers->d;
+    numThreads = aNumThreads;
+    useKdTree = (d <= MAX_KD_TREE_DIMENSION);
+
+    if (! useKdTree) {
+        numGroups = std::max(1, (int)sqrt((double)k));
+        anchors = new Dataset(numGroups, d);
+        groupRadius = new double[numGroups];
+        groupGrowth = new double[numGroups];
+        groupStart = new int[numGroups + 1];
+        groupMembers = new int[k];
+        groupOrder = new std::pair<double, int> *[numThreads];
+        for (int t = 0; t < numThreads; ++t) {
+            groupOrder[t] = new std::pair<double, int>[numGroups];
+        }
+    }
+
+    rebuild();
+}
+
+void NearCenterIndex::rebuild() {
+    if (useKdTree) {
+        delete tree;
+        tree = new KdTree(centers, 1, 4);
+        return;
+    }
+
+    // spread the anchors evenly over the center indexes
+    for (int g = 0; g < numGroups; ++g) {
+        int j = (int)((long long)g * k / numGroups);
+        std::copy(centers->data + j * d, centers->data + (j + 1) * d, anchors->data + g * d);
+    }
+
+    // put each center in the group of its closest anchor, with a counting
+    // sort by group
+    int *group = new int[k];
+    std::fill(groupStart, groupStart + numGroups + 1, 0);
+    std::fill(groupRadius, groupRadius + numGroups, 0.0);
+    std::fill(groupGrowth, groupGrowth + numGroups, 0.0);
+    for (int j = 0; j < k; ++j) {
+        double const *cp = centers->data + j * d;
+        double closestDist2 = std::numeric_limits<double>::max();
+        for (int g = 0; g < numGroups; ++g) {
+            double d2 = distance2(cp, anchors->data + g * d, d);
+            if (d2 < closestDist2) {
+                closestDist2 = d2;
+                group[j] = g;
+            }
+        }
+        groupRadius[group[j]] = std::max(groupRadius[group[j]], sqrt(closestDist2));
+        ++groupStart[group[j] + 1];
+    }
+    for (int g = 0; g < numGroups; ++g) {
+        groupStart[g + 1] += groupStart[g];
+    }
+    int *next = new int[numGroups];
+    std::copy(groupStart, groupStart + numGroups, next);
+    for (int j = 0; j < k; ++j) {
+        groupMembers[next[group[j]]++] = j;
+    }
+
+    delete [] next;
+    delete [] group;
+}
+
+void NearCenterIndex::update(double const *centerMovement) {
+    if (*std::max_element(centerMovement, centerMovement + k) == 0.0) {
+        return;
+    }
+
+    if (useKdTree) {
+        rebuild();
+        return;
+    }
+
+    // patch the group radii by the furthest any member moved
+    double averageRadius = 0.0, maxGrowth = 0.0;
+    for (int g = 0; g < numGroups; ++g) {
+        double moved = 0.0;
+        for (int m = groupStart[g]; m < groupStart[g + 1]; ++m) {
+            moved = std::max(moved, centerMovement[groupMembers[m]]);
+        }
+        groupGrowth[g] += moved;
+        averageRadius += groupRadius[g];
+        maxGrowth = std::max(maxGrowth, groupGrowth[g]);
+    }
+    averageRadius /= numGroups;
+
+    if (maxGrowth > MAX_GROUP_GROWTH * averageRadius) {
+        rebuild();
+    }
+}
+
+void NearCenterIndex::offer(double d2, int j, int m, double *radius2, std::pair<double, int> *result, int *found) {
+    if (d2 > *radius2) {
+        return;
+    }
+    std::pair<double, int> candidate(d2, j);
+    if (*found == m) {
+        if (! (candidate < result[m - 1])) {
+            return;
+        }
+    } else {
+        ++*found;
+    }
+
+    // insert into the sorted results, dropping the last one if full
+    int pos = *found - 1;
+    while (pos > 0 && candidate < result[pos - 1]) {
+        result[pos] = result[pos - 1];
+        --pos;
+    }
+    result[pos] = candidate;
+
+    if (*found == m) {
+        *radius2 = result[m - 1].first;
+    }
+}
+
+void NearCenterIndex::searchTree(int node, double const *xp, int m, double *radius2, std::pair<double, int> *result, int *found) const {
+    if (tree->isLeaf(node)) {
+        for (int p = tree->nodeStart[node]; p < tree->nodeEnd[node]; ++p) {
+            int j = tree->index[p];
+            offer(distance2(xp, centers->data + j * d, d), j, m, radius2, result, found);
+        }
+        #ifdef COUNT_DISTANCES
+        numDistances += tree->count(node);
+        #endif
+        return;
+    }
+
+    // visit the child whose box is closer first
+    int children[2] = { tree->left(node), tree->right(node) };
+    double boxDist2[2] = { 0.0, 0.0 };
+    for (int c = 0; c < 2; ++c) {
+        double const *lo = tree->lower + children[c] * d;
+        double const *hi = tree->upper + children[c] * d;
+        for (int dim = 0; dim < d; ++dim) {
+            double diff = (xp[dim] < lo[dim]) ? lo[dim] - xp[dim] : ((hi[dim] < xp[dim]) ? xp[dim] - hi[dim] : 0.0);
+            boxDist2[c] += diff * diff;
+        }
+    }
+    int first = (boxDist2[1] < boxDist2[0]) ? 1 : 0;
+    for (int c = first, visited = 0; visited < 2; c = 1 - c, ++visited) {
+        if (boxDist2[c] <= *radius2) {
+            searchTree(children[c], xp, m, radius2, result, found);
+        }
+    }
+}
+
+int NearCenterIndex::nearest(double const *xp, int m, double radius2, std::pair<double, int> *result, int threadId) const {
+    int found = 0;
+    m = std::min(m, k);
+
+    if (useKdTree) {
+        searchTree(0, xp, m, &radius2, result, &found);
+        return found;
+    }
+
+    // visit the groups in order of the lower bound on their members' distance
+    std::pair<double, int> *order = groupOrder[threadId];
+    for (int g = 0; g < numGroups; ++g) {
+        double lowerBound = sqrt(distance2(xp, anchors->data + g * d, d)) - groupRadius[g] - groupGrowth[g];
+        order[g].first = (lowerBound > 0.0) ? lowerBound * lowerBound : 0.0;
+        order[g].second = g;
+    }
+    std::sort(order, order + numGroups);
+    #ifdef COUNT_DISTANCES
+    numDistances += numGroups;
+    #endif
+
+    for (int o = 0; o < numGroups && order[o].first <= radius2; ++o) {
+        int g = order[o].second;
+        for (int mi = groupStart[g]; mi < groupStart[g + 1]; ++mi) {
+            int j = groupMembers[mi];
+            offer(distance2(xp, centers->data + j * d, d), j, m, &radius2, result, &found);
+        }
+        #ifdef COUNT_DISTANCES
+        numDistances += groupStart[g + 1] - groupStart[g];
+        #endif
+    }
+
+    return found;
+}
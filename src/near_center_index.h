@@ -0,0 +1,91 @@
+#ifndef NEAR_CENTER_INDEX_H
+#define NEAR_CENTER_INDEX_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * NearCenterIndex answers exact nearest-center queries (the m nearest centers
+ * to a point, usually m = 1 or 2) without scanning all k centers. It is meant
+ * for bounds-based algorithms with large k, where the full rescan done when a
+ * point's bounds fail dominates the running time.
+ *
+ * In low dimension the centers are kept in a kd-tree, which is rebuilt each
+ * time the centers move. In high dimension the centers are partitioned into
+ * about sqrt(k) groups around fixed anchors, each with a radius that bounds the
+ * distance from the anchor to its members; when the centers move, the radii
+ * are patched by the distance moved, and the groups are rebuilt only once the
+ * radii have grown too much.
+ */
+
+#include "dataset.h"
+#include "kd_tree.h"
+#include <utility>
+
+class NearCenterIndex {
+    public:
+        NearCenterIndex();
+        ~NearCenterIndex() { free(); }
+
+        // Index the given centers, which may be queried by up to numThreads
+        // threads at once. The index refers to the centers (it does not copy
+        // them), so it must be updated whenever they move.
+        void initialize(Dataset const *aCenters, int aNumThreads);
+        void free();
+
+        // Bring the index up to date after center j has moved by
+        // centerMovement[j].
+        void update(double const *centerMovement);
+
+        // Find the m nearest centers to the point xp, among those whose
+        // squared distance is at most radius2. The results are written to
+        // result in order of increasing (squared distance, center index), and
+        // the number of results found (at most m) is returned.
+        int nearest(double const *xp, int m, double radius2, std::pair<double, int> *result, int threadId) const;
+
+        // Whether the index uses a kd-tree (rather than groups).
+        bool usesKdTree() const { return useKdTree; }
+
+        #ifdef COUNT_DISTANCES
+        // The number of point-center distances computed by queries; the
+        // caller collects (and resets) this count.
+        mutable long long numDistances;
+        #endif
+
+    private:
+        // Rebuild the structure from the current center locations.
+        void rebuild();
+
+        // Search the subtree of the kd-tree rooted at node.
+        void searchTree(int node, double const *xp, int m, double *radius2, std::pair<double, int> *result, int *found) const;
+
+        // Offer a center as a result, keeping the m best found so far.
+        static void offer(double dist2, int j, int m, double *radius2, std::pair<double, int> *result, int *found);
+
+        Dataset const *centers;
+        int k, d, numThreads;
+        bool useKdTree;
+
+        // The kd-tree over the centers (low dimension).
+        KdTree *tree;
+
+        // The groups (high dimension): each group's anchor location, the
+        // distance bound from the anchor to any member when the groups were
+        // built, how much that bound has grown since, and the members of
+        // group g, which are groupMembers[groupStart[g]] ...
+        // groupMembers[groupStart[g + 1] - 1].
+        int numGroups;
+        Dataset *anchors;
+        double *groupRadius, *groupGrowth;
+        int *groupStart, *groupMembers;
+
+        // For each thread, scratch space for ordering the groups in a query.
+        std::pair<double, int> **groupOrder;
+
+        // Disallow copies.
+        NearCenterIndex(NearCenterIndex const &);
+        NearCenterIndex const &operator=(NearCenterIndex const &);
+};
+
+#endif
@@ -23,6 +23,7 @@ class OriginalSpaceKmeans : public Kmeans {
         OriginalSpaceKmeans();
         virtual ~OriginalSpaceKmeans() { free(); }
         virtual void free(); 
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
 
         virtual double pointPointInnerProduct(int x1ndx, int x2ndx) const;
@@ -8,30 +8,34 @@
 
 #include <cstring> // For strrchr
 
-#include "py_annulus.h"
 #include "py_assignment.h"
-#include "py_compare.h"
+#include "py_center_index.h"
 #include "py_dataset.h"
-#include "py_drake.h"
-#include "py_elkan.h"
-#include "py_hamerly.h"
-#include "py_heap.h"
 #include "py_fastkmeans_methods.h"
-#include "py_naive.h"
-#include "py_sort.h"
+#include "py_kmeans.h"
 
 extern "C" {
     static PyTypeObject *type_object_ptrs[] = {
-        &AnnulusType,
         &AssignmentType,
-        &CompareType,
+        &CenterIndexType,
         &DatasetType,
+
+        // The base type must be ready before the algorithm types
+        &KmeansType,
+        &AdaptiveType,
+        &AnnulusType,
+        &CompareType,
         &DrakeType,
         &ElkanType,
         &HamerlyType,
         &HeapType,
+        &KdTreeType,
+        &MiniBatchType,
         &NaiveType,
         &SortType,
+        &ElkanKernelType,
+        &HamerlyKernelType,
+        &NaiveKernelType,
         NULL
     };
 
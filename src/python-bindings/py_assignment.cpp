@@ -3,8 +3,10 @@
  */
 
 #include "py_assignment.h"
+#include "py_dataset.h"
 
 #include <climits>
+#include <stdint.h>
 
 /*
 typedef struct {
@@ -14,8 +16,120 @@ typedef struct {
 } AssignmentObject;
 */
 
+// Free the assignment, or release the buffer it was made from.
+static void Assignment_release(AssignmentObject *self) {
+    if (self->view.obj != NULL) {
+        PyBuffer_Release(&self->view);
+    } else {
+        delete [] self->assignment;
+    }
+    self->assignment = NULL;
+    self->n = 0;
+}
+
+// Copy n integers of type T into assignment, returning false if one of them
+// is not an unsigned short.
+template <class T>
+static bool copy_assignment(void const *buf, int n,
+        unsigned short *assignment) {
+    T const *values = (T const *) buf;
+    for (int i = 0; i < n; ++i) {
+        if (values[i] < 0 || (uintmax_t) values[i] > USHRT_MAX) {
+            return false;
+        }
+        assignment[i] = (unsigned short) values[i];
+    }
+    return true;
+}
+
+static int Assignment_init_from_buffer(AssignmentObject *self,
+        PyObject *array) {
+    // use the array's memory if it is writable, otherwise copy it
+    Py_buffer view;
+    int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT;
+    if (PyObject_GetBuffer(array, &view, flags | PyBUF_WRITABLE) != 0) {
+        PyErr_Clear();
+        if (PyObject_GetBuffer(array, &view, flags) != 0) {
+            return -1;
+        }
+    }
+
+    char type = buffer_type(view.format);
+    bool isSigned = (type == 'b' || type == 'h' || type == 'i' || type == 'l'
+            || type == 'q' || type == 'n');
+    bool isUnsigned = (type == 'B' || type == 'H' || type == 'I' || type == 'L'
+            || type == 'Q' || type == 'N');
+    if (view.ndim != 1 || ! (isSigned || isUnsigned)) {
+        PyErr_SetString(PyExc_ValueError, "array must be 1-dimensional, of "
+                "integers");
+        PyBuffer_Release(&view);
+        return -1;
+    }
+    if (view.shape[0] > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "array is too large");
+        PyBuffer_Release(&view);
+        return -1;
+    }
+
+    int n = view.shape[0];
+    if (isUnsigned && view.itemsize == sizeof(unsigned short)
+            && ! view.readonly) {
+        self->n = n;
+        self->assignment = (unsigned short *) view.buf;
+        self->view = view;
+        return 0;
+    }
+
+    bool copied = false;
+    unsigned short *assignment = new unsigned short[n];
+    switch (view.itemsize) {
+        case 1:
+            copied = isSigned ? copy_assignment<int8_t>(view.buf, n, assignment)
+                : copy_assignment<uint8_t>(view.buf, n, assignment);
+            break;
+        case 2:
+            copied = isSigned ? copy_assignment<int16_t>(view.buf, n, assignment)
+                : copy_assignment<uint16_t>(view.buf, n, assignment);
+            break;
+        case 4:
+            copied = isSigned ? copy_assignment<int32_t>(view.buf, n, assignment)
+                : copy_assignment<uint32_t>(view.buf, n, assignment);
+            break;
+        case 8:
+            copied = isSigned ? copy_assignment<int64_t>(view.buf, n, assignment)
+                : copy_assignment<uint64_t>(view.buf, n, assignment);
+            break;
+    }
+    PyBuffer_Release(&view);
+    if (! copied) {
+        delete [] assignment;
+        PyErr_SetString(PyExc_ValueError, "values must be unsigned shorts");
+        return -1;
+    }
+
+    self->n = n;
+    self->assignment = assignment;
+    return 0;
+}
+
 static int Assignment_init(AssignmentObject *self, PyObject *args) {
     // Assignment(n)
+    // Assignment(an_array)
+
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot reinitialize an assignment "
+                "whose memory is shared");
+        return -1;
+    }
+    Assignment_release(self);
+
+    PyObject *obj;
+    if (!PyArg_ParseTuple(args, "O", &obj)) {
+        return -1;
+    }
+    if (PyObject_CheckBuffer(obj)) {
+        return Assignment_init_from_buffer(self, obj);
+    }
 
     int n;
     if (!PyArg_ParseTuple(args, "i", &n)) {
@@ -29,8 +143,7 @@ static int Assignment_init(AssignmentObject *self, PyObject *args) {
 }
 
 static void Assignment_dealloc(AssignmentObject *self) {
-    delete self->assignment;
-    self->n = 0;
+    Assignment_release(self);
     Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
@@ -134,6 +247,40 @@ static int Assignment_ass_item(AssignmentObject *self, Py_ssize_t i,
     return 0;
 }
 
+static int Assignment_getbuffer(AssignmentObject *self, Py_buffer *view,
+        int flags) {
+    // memoryview(an_assignment), numpy.asarray(an_assignment)
+
+    self->shape[0] = self->n;
+    self->strides[0] = sizeof(unsigned short);
+
+    view->buf = self->assignment;
+    Py_INCREF(self);
+    view->obj = (PyObject *) self;
+    view->len = self->n * sizeof(unsigned short);
+    view->readonly = 0;
+    view->itemsize = sizeof(unsigned short);
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>("H") : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides
+        : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    ++self->exports;
+    return 0;
+}
+
+static void Assignment_releasebuffer(AssignmentObject *self, Py_buffer *view) {
+    --self->exports;
+}
+
+static PyBufferProcs Assignment_buffer_procs = {
+    (getbufferproc) Assignment_getbuffer,
+    (releasebufferproc) Assignment_releasebuffer
+};
+
 static PySequenceMethods Assignment_sequence_methods = {
     (lenfunc) Assignment_len,
     NULL,       // sq_concat
@@ -170,7 +317,7 @@ PyTypeObject AssignmentType = {
     NULL, // tp_getattro
     NULL, // tp_setattro
 
-    NULL, // tp_as_buffer
+    &Assignment_buffer_procs, // tp_as_buffer
 
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, // tp_flags
 
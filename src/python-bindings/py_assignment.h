@@ -7,6 +7,13 @@
  * Assignment instances are returned by the fastkmeans.assign method and can be
  * passed to the [kmeans_algorithm].initialize methods, so the user should not
  * have to deal with it in depth under normal circumstances.
+ *
+ * An Assignment can also be made from any object with the buffer protocol
+ * holding a 1-d array of integers (such as a NumPy array). The memory of a
+ * writable, C-contiguous uint16 array is used directly, so the algorithms
+ * write their assignment into it; other integer arrays are copied. An
+ * Assignment also provides the buffer protocol itself (as uint16), so
+ * numpy.asarray(an_assignment) shares its memory.
  */
 
 #include <Python.h>
@@ -16,6 +23,15 @@ typedef struct {
     PyObject_HEAD
     int n;
     unsigned short *assignment;
+
+    // The buffer whose memory the assignment uses, if it was made from one
+    // (otherwise view.obj is NULL).
+    Py_buffer view;
+
+    // The shape and strides given to consumers of this object's buffer, and
+    // how many of them hold it.
+    Py_ssize_t shape[1], strides[1];
+    int exports;
 } AssignmentObject;
 
 extern PyTypeObject AssignmentType;
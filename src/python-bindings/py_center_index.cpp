@@ -0,0 +1,352 @@
+/* CenterIndex wrapper. The comment at the beginning of each function
+ * definition demonstrates its usage in Python.
+ */
+
+#include "py_center_index.h"
+
+#include "py_assignment.h"
+#include "py_dataset.h"
+
+
+// CenterIndex instance object
+
+
+/*
+typedef struct {
+    PyObject_HEAD
+    CenterIndexServer *server;
+    int maxNeighbors;
+    PyThread_type_lock updateLock;
+    int active;
+} CenterIndexObject;
+*/
+
+
+// Object special methods
+
+
+static int CenterIndex_init(CenterIndexObject *self, PyObject *args,
+        PyObject *kwargs) {
+    // CenterIndex(centers, max_neighbors=64)
+
+    PyObject *c;
+    int maxNeighbors = 64;
+
+    char *emptyStr = const_cast<char *>("");
+    char *kwlist[] = {emptyStr, const_cast<char *>("max_neighbors"), NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|i", kwlist,
+                &DatasetType, &c, &maxNeighbors)) {
+        return -1;
+    }
+
+    DatasetObject *centers = (DatasetObject *) c;
+    if (centers->dataset->n < 1) {
+        PyErr_SetString(PyExc_ValueError, "need at least one center");
+        return -1;
+    }
+    if (self->active > 0) {
+        PyErr_SetString(PyExc_RuntimeError, "cannot reinitialize a center "
+                "index that is in use in another thread");
+        return -1;
+    }
+    if (self->updateLock == NULL) {
+        self->updateLock = PyThread_allocate_lock();
+        if (self->updateLock == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+
+    delete self->server;
+    self->maxNeighbors = maxNeighbors;
+    self->server = new CenterIndexServer(new CenterIndex(*(centers->dataset),
+                maxNeighbors));
+
+    return 0;
+}
+
+static void CenterIndex_dealloc(CenterIndexObject *self) {
+    delete self->server;
+    self->server = NULL;
+    if (self->updateLock != NULL) {
+        PyThread_free_lock(self->updateLock);
+        self->updateLock = NULL;
+    }
+
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+
+// Object properties
+
+
+static PyObject * CenterIndex_get_k(CenterIndexObject *self, void *closure) {
+    // a_center_index.k
+
+    int slot = self->server->acquire();
+    int k = self->server->get(slot)->getK();
+    self->server->release(slot);
+
+    return PyLong_FromLong(k);
+}
+
+static PyObject * CenterIndex_get_d(CenterIndexObject *self, void *closure) {
+    // a_center_index.d
+
+    int slot = self->server->acquire();
+    int d = self->server->get(slot)->getD();
+    self->server->release(slot);
+
+    return PyLong_FromLong(d);
+}
+
+static PyObject * CenterIndex_get_centers(CenterIndexObject *self,
+        void *closure) {
+    // a_center_index.centers
+
+    int slot = self->server->acquire();
+    Dataset const *centers = self->server->get(slot)->getCenters();
+
+    PyObject *centersObj = Dataset_copy(centers);
+    self->server->release(slot);
+
+    return centersObj;
+}
+
+static PyGetSetDef CenterIndex_getsetters[] = {
+    {
+        const_cast<char *>("k"),
+        (getter) CenterIndex_get_k,
+        NULL, // Setter
+        const_cast<char *>("The number of centers"),
+    },
+    {
+        const_cast<char *>("d"),
+        (getter) CenterIndex_get_d,
+        NULL, // Setter
+        const_cast<char *>("The dimension"),
+    },
+    {
+        const_cast<char *>("centers"),
+        (getter) CenterIndex_get_centers,
+        NULL, // Setter
+        const_cast<char *>("A copy of the centers being served"),
+    },
+    {NULL} // Sentinel
+};
+
+
+// CenterIndex methods
+
+
+static PyObject * CenterIndex_nearest(CenterIndexObject *self, PyObject *o) {
+    // a_center_index.nearest(a_sequence_of_d_floats) -> (label, distance)
+
+    PyObject *seq = PySequence_Fast(o, "expected a sequence of floats");
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    int slot = self->server->acquire();
+    CenterIndex const *index = self->server->get(slot);
+    int d = index->getD();
+
+    PyObject *result = NULL;
+    if (PySequence_Fast_GET_SIZE(seq) != d) {
+        PyErr_SetString(PyExc_ValueError, "the point must have d values");
+    } else {
+        double *xp = new double[d];
+        for (int dim = 0; dim < d; ++dim) {
+            xp[dim] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, dim));
+        }
+        if (PyErr_Occurred() == NULL) {
+            double dist;
+            int label = index->nearest(xp, &dist);
+            result = Py_BuildValue("id", label, dist);
+        }
+        delete [] xp;
+    }
+
+    self->server->release(slot);
+    Py_DECREF(seq);
+
+    return result;
+}
+
+static PyObject * CenterIndex_assign(CenterIndexObject *self, PyObject *args,
+        PyObject *kwargs) {
+    // a_center_index.assign(dataset, assignment, num_threads=1,
+    //                       distances=None)
+
+    PyObject *x, *a, *dist = NULL;
+    int numThreads = 1;
+
+    char *emptyStr = const_cast<char *>("");
+    char *kwlist[] = {emptyStr, emptyStr, const_cast<char *>("num_threads"),
+        const_cast<char *>("distances"), NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!|iO!", kwlist,
+                &DatasetType, &x, &AssignmentType, &a, &numThreads,
+                &DatasetType, &dist)) {
+        return NULL;
+    }
+
+    DatasetObject *dataset = (DatasetObject *) x;
+    AssignmentObject *assignment = (AssignmentObject *) a;
+    DatasetObject *distances = (DatasetObject *) dist;
+
+    int n = dataset->dataset->n;
+    if (assignment->n != n) {
+        PyErr_SetString(PyExc_ValueError, "the assignment must have one entry "
+                "per record");
+        return NULL;
+    }
+    if (distances && distances->dataset->n * distances->dataset->d != n) {
+        PyErr_SetString(PyExc_ValueError, "distances must have one entry per "
+                "record");
+        return NULL;
+    }
+    if (distances && distances->view.obj != NULL && distances->view.readonly) {
+        PyErr_SetString(PyExc_TypeError, "distances is read-only");
+        return NULL;
+    }
+
+    BufferHolds holds;
+    if (!holds.hold(x, PyBUF_SIMPLE) || !holds.hold(a, PyBUF_WRITABLE) ||
+            !holds.hold(dist, PyBUF_WRITABLE)) {
+        return NULL;
+    }
+
+    int slot = self->server->acquire();
+    CenterIndex const *index = self->server->get(slot);
+    if (dataset->dataset->d != index->getD()) {
+        self->server->release(slot);
+        PyErr_SetString(PyExc_ValueError, "the dataset must have dimension d");
+        return NULL;
+    }
+    ++self->active;
+    Py_BEGIN_ALLOW_THREADS
+    index->nearest(*(dataset->dataset), assignment->assignment,
+            distances ? distances->dataset->data : NULL, numThreads);
+    self->server->release(slot);
+    Py_END_ALLOW_THREADS
+    --self->active;
+
+    Py_RETURN_NONE;
+}
+
+static PyObject * CenterIndex_update(CenterIndexObject *self, PyObject *args) {
+    // a_center_index.update(centers)
+
+    PyObject *c;
+    if (!PyArg_ParseTuple(args, "O!", &DatasetType, &c)) {
+        return NULL;
+    }
+
+    DatasetObject *centers = (DatasetObject *) c;
+    if (centers->dataset->n < 1) {
+        PyErr_SetString(PyExc_ValueError, "need at least one center");
+        return NULL;
+    }
+
+    CenterIndex *index = new CenterIndex(*(centers->dataset),
+            self->maxNeighbors);
+
+    // the swap waits for the queries using the old index, which may need the
+    // GIL to finish
+    ++self->active;
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->updateLock, WAIT_LOCK);
+    self->server->swap(index);
+    PyThread_release_lock(self->updateLock);
+    Py_END_ALLOW_THREADS
+    --self->active;
+
+    Py_RETURN_NONE;
+}
+
+
+// CenterIndex method definitions
+
+
+static PyMethodDef CenterIndex_methods[] = {
+    {"nearest", (PyCFunction) CenterIndex_nearest, METH_O,
+        "Return the closest center to the given point (a sequence of d "
+            "floats), and the distance to it"},
+    {"assign", (PyCFunction) CenterIndex_assign,
+        METH_VARARGS | METH_KEYWORDS,
+        "Assign each record of the dataset to its closest center, with the "
+            "given number of threads; optionally also fill in the distances "
+            "(a Dataset with one entry per record)"},
+    {"update", (PyCFunction) CenterIndex_update, METH_VARARGS,
+        "Index and serve a new set of centers from now on (queries already "
+            "running finish with the old ones)"},
+    {NULL} // Sentinel
+};
+
+
+// CenterIndex type object
+
+
+PyTypeObject CenterIndexType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "fastkmeans.CenterIndex", // tp_name
+    sizeof(CenterIndexObject), // tp_basicsize
+    0, // tp_itemsize
+
+    (destructor) CenterIndex_dealloc, // tp_dealloc
+    NULL, // tp_print
+    NULL, // tp_getattr
+    NULL, // tp_setattr
+    NULL, // tp_as_sync
+    NULL, // tp_repr
+
+    NULL, // tp_as_number
+    NULL, // tp_as_sequence
+    NULL, // tp_as_mapping
+
+    NULL, // tp_hash
+    NULL, // tp_call
+    NULL, // tp_str
+    NULL, // tp_getattro
+    NULL, // tp_setattro
+
+    NULL, // tp_as_buffer
+
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, // tp_flags
+
+    "Serves nearest-center lookups for a set of centers", // tp_doc
+
+    NULL, // tp_traverse
+
+    NULL, // tp_clear
+
+    NULL, // tp_richcompare
+
+    0, // tp_weaklistoffset
+
+    NULL, // tp_iter
+    NULL, // tp_iternext
+
+    CenterIndex_methods, // tp_methods
+    NULL, // tp_members
+    CenterIndex_getsetters, // tp_getset
+    NULL, // tp_base
+    NULL, // tp_dict
+    NULL, // tp_descr_get
+    NULL, // tp_descr_set
+    0, // tp_dictoffset
+    (initproc) CenterIndex_init, // tp_init
+    PyType_GenericAlloc, // tp_alloc
+    PyType_GenericNew, // tp_new
+    NULL, // tp_free
+    NULL, // tp_is_gc
+    NULL, // tp_bases
+    NULL, // tp_mro
+    NULL, // tp_cache
+    NULL, // tp_subclasses
+    NULL, // tp_weaklist
+    NULL, // tp_del
+
+    0, // tp_version_tag
+    NULL, // tp_finalize
+};
@@ -0,0 +1,31 @@
+#ifndef PY_CENTER_INDEX_H
+#define PY_CENTER_INDEX_H
+
+/* Provides a wrapper for serving nearest-center lookups with a CenterIndex
+ * (through a CenterIndexServer, so that a newly trained set of centers can be
+ * swapped in). See center_index.h for more detail.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include "center_index.h"
+
+typedef struct {
+    PyObject_HEAD
+    CenterIndexServer *server;
+    int maxNeighbors;
+
+    // Serializes update(), since swaps must not run concurrently with each
+    // other (each waits, with the GIL released, for the queries using the old
+    // index to finish).
+    PyThread_type_lock updateLock;
+
+    // The number of assign() and update() calls using the server with the
+    // GIL released; __init__ must not replace the server while there are any.
+    int active;
+} CenterIndexObject;
+
+extern PyTypeObject CenterIndexType;
+
+#endif
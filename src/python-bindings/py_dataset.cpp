@@ -6,6 +6,7 @@
 
 // #include "dataset.h"
 
+#include <algorithm>
 #include <climits>
 #include <sstream>
 
@@ -16,8 +17,106 @@ typedef struct {
 } DatasetObject;
 */
 
+char buffer_type(char const *format) {
+    if (format == NULL) {
+        return 'B';
+    }
+    switch (*format) {
+        case '@':
+        case '=':
+            ++format;
+            break;
+        #if PY_LITTLE_ENDIAN
+        case '<':
+        #else
+        case '>':
+        case '!':
+        #endif
+            ++format;
+            break;
+    }
+    return (format[0] != '\0' && format[1] == '\0') ? format[0] : 0;
+}
+
+// Free the dataset, and release the buffer it was made from (if any).
+static void Dataset_release(DatasetObject *self) {
+    if (self->dataset != NULL && self->view.obj != NULL) {
+        // the memory belongs to the buffer
+        self->dataset->data = NULL;
+    }
+    delete self->dataset;
+    self->dataset = NULL;
+    if (self->view.obj != NULL) {
+        PyBuffer_Release(&self->view);
+    }
+}
+
+static int Dataset_init_from_buffer(DatasetObject *self, PyObject *array,
+        int keepSDS) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(array, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)
+            != 0) {
+        return -1;
+    }
+
+    char type = buffer_type(view.format);
+    if (view.ndim != 2 || (type != 'd' && type != 'f')
+            || view.itemsize != (Py_ssize_t) (type == 'd' ? sizeof(double) : sizeof(float))) {
+        PyErr_SetString(PyExc_ValueError, "array must be 2-dimensional, of "
+                "float64 or float32");
+        PyBuffer_Release(&view);
+        return -1;
+    }
+    if (view.shape[0] > INT_MAX || view.shape[1] > INT_MAX
+            || view.shape[0] * view.shape[1] > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "array is too large");
+        PyBuffer_Release(&view);
+        return -1;
+    }
+
+    int n = view.shape[0], d = view.shape[1];
+    if (type == 'd') {
+        // use the array's memory
+        self->dataset = new Dataset();
+        self->dataset->n = n;
+        self->dataset->d = d;
+        self->dataset->nd = n * d;
+        self->dataset->data = (double *) view.buf;
+        self->dataset->sumDataSquared = keepSDS ? new double[n] : NULL;
+        self->view = view;
+    } else {
+        float const *values = (float const *) view.buf;
+        self->dataset = new Dataset(n, d, keepSDS);
+        std::copy(values, values + n * d, self->dataset->data);
+        PyBuffer_Release(&view);
+    }
+
+    return 0;
+}
+
 static int Dataset_init(DatasetObject *self, PyObject *args, PyObject *kwargs) {
     // Dataset(aN, aD, keep_sds=False)
+    // Dataset(an_array, keep_sds=False)
+
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot reinitialize a dataset "
+                "whose memory is shared");
+        return -1;
+    }
+    Dataset_release(self);
+
+    if (PyTuple_Size(args) >= 1
+            && PyObject_CheckBuffer(PyTuple_GetItem(args, 0))) {
+        PyObject *array;
+        int keepSDS = 0;
+        char *emptyStr = const_cast<char *>("");
+        char *kwlist[] = {emptyStr, const_cast<char *>("keep_sds"), NULL};
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|p", kwlist, &array,
+                    &keepSDS)) {
+            return -1;
+        }
+        return Dataset_init_from_buffer(self, array, keepSDS);
+    }
 
     int aN, aD, keepSDS = 0;
     char *emptyStr = const_cast<char *>("");
@@ -33,7 +132,7 @@ static int Dataset_init(DatasetObject *self, PyObject *args, PyObject *kwargs) {
 }
 
 static void Dataset_dealloc(DatasetObject *self) {
-    delete self->dataset;
+    Dataset_release(self);
     Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
@@ -46,6 +145,12 @@ static PyObject * Dataset_get_n(DatasetObject *self, void *closure) {
 static int Dataset_set_n(DatasetObject *self, PyObject *value, void *closure) {
     // a_dataset.n = some_val
 
+    if (self->view.obj != NULL || self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot resize a dataset whose "
+                "memory is shared");
+        return -1;
+    }
+
     if (PyLong_Check(value)) {
         long newN = PyLong_AsLong(value);
 
@@ -74,6 +179,12 @@ static PyObject * Dataset_get_d(DatasetObject *self, void *closure) {
 static int Dataset_set_d(DatasetObject *self, PyObject *value, void *closure) {
     // a_dataset.d = some_val
 
+    if (self->view.obj != NULL || self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot resize a dataset whose "
+                "memory is shared");
+        return -1;
+    }
+
     if (PyLong_Check(value)) {
         long newD = PyLong_AsLong(value);
 
@@ -106,6 +217,11 @@ static PyObject * Dataset_fill(DatasetObject *self, PyObject *o) {
 
     double value = 0.0;
 
+    if (self->view.obj != NULL && self->view.readonly) {
+        PyErr_SetString(PyExc_TypeError, "dataset is read-only");
+        return NULL;
+    }
+
     // Check whether a numeric type
     if (PyFloat_Check(o)) {
         value = PyFloat_AsDouble(o);
@@ -196,6 +312,11 @@ static int Dataset_ass_subscript(DatasetObject *self, PyObject *key,
         if (0 <= i && i < self->dataset->n && 0 <= j && j < self->dataset->d) {
             double val = -1.0;
 
+            if (self->view.obj != NULL && self->view.readonly) {
+                PyErr_SetString(PyExc_TypeError, "dataset is read-only");
+                return -1;
+            }
+
             if (PyFloat_Check(v)) {
                 val = PyFloat_AsDouble(v);
             } else if (PyLong_Check(v)) {
@@ -231,6 +352,49 @@ static PyMappingMethods Dataset_mapping_methods = {
     (objobjargproc) Dataset_ass_subscript
 };
 
+static int Dataset_getbuffer(DatasetObject *self, Py_buffer *view, int flags) {
+    // memoryview(a_dataset), numpy.asarray(a_dataset)
+
+    bool readonly = self->view.obj != NULL && self->view.readonly;
+    if ((flags & PyBUF_WRITABLE) && readonly) {
+        PyErr_SetString(PyExc_BufferError, "dataset is read-only");
+        view->obj = NULL;
+        return -1;
+    }
+
+    Dataset *dataset = self->dataset;
+    self->shape[0] = dataset->n;
+    self->shape[1] = dataset->d;
+    self->strides[0] = dataset->d * sizeof(double);
+    self->strides[1] = sizeof(double);
+
+    view->buf = dataset->data;
+    Py_INCREF(self);
+    view->obj = (PyObject *) self;
+    view->len = dataset->nd * sizeof(double);
+    view->readonly = readonly;
+    view->itemsize = sizeof(double);
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>("d") : NULL;
+    view->ndim = 2;
+    view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides
+        : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    ++self->exports;
+    return 0;
+}
+
+static void Dataset_releasebuffer(DatasetObject *self, Py_buffer *view) {
+    --self->exports;
+}
+
+static PyBufferProcs Dataset_buffer_procs = {
+    (getbufferproc) Dataset_getbuffer,
+    (releasebufferproc) Dataset_releasebuffer
+};
+
 PyTypeObject DatasetType = {
     PyVarObject_HEAD_INIT(NULL, 0)
     "fastkmeans.Dataset", // tp_name = ""
@@ -254,7 +418,7 @@ PyTypeObject DatasetType = {
     NULL, // tp_getattro
     NULL, // tp_setattro
 
-    NULL, // tp_as_buffer
+    &Dataset_buffer_procs, // tp_as_buffer
 
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, // tp_flags
 
@@ -294,3 +458,22 @@ PyTypeObject DatasetType = {
     0, // tp_version_tag
     NULL, // tp_finalize
 };
+
+PyObject * Dataset_wrap(Dataset *dataset) {
+    if (dataset == NULL) {
+        Py_RETURN_NONE;
+    }
+
+    DatasetObject *obj = (DatasetObject *) DatasetType.tp_alloc(&DatasetType, 0);
+    if (obj == NULL) {
+        delete dataset;
+        return NULL;
+    }
+    obj->dataset = dataset;
+
+    return (PyObject *) obj;
+}
+
+PyObject * Dataset_copy(Dataset const *dataset) {
+    return Dataset_wrap(dataset ? new Dataset(*dataset) : NULL);
+}
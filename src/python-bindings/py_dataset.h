@@ -2,6 +2,12 @@
 #define PY_DATASET_H
 
 /* Provides a wrapper for the Dataset class. See dataset.h for more detail.
+ *
+ * A Dataset can be made from any object with the buffer protocol holding a
+ * C-contiguous 2-d array (such as a NumPy array). The memory of a float64
+ * array is used directly, without copying; a float32 array is converted once,
+ * since the algorithms compute in double precision. A Dataset also provides
+ * the buffer protocol itself, so numpy.asarray(a_dataset) shares its memory.
  */
 
 #include <Python.h>
@@ -12,8 +18,65 @@
 typedef struct {
     PyObject_HEAD
     Dataset *dataset;
+
+    // The buffer whose memory the dataset uses, if it was made from one
+    // (otherwise view.obj is NULL).
+    Py_buffer view;
+
+    // The shape and strides given to consumers of this object's buffer, and
+    // how many of them hold it.
+    Py_ssize_t shape[2], strides[2];
+    int exports;
 } DatasetObject;
 
 extern PyTypeObject DatasetType;
 
+// Return a new Dataset object that owns the given dataset, or None if it is
+// NULL.
+PyObject * Dataset_wrap(Dataset *dataset);
+
+// Return a new Dataset object holding a copy of the given dataset, or None if
+// it is NULL.
+PyObject * Dataset_copy(Dataset const *dataset);
+
+// The type code ('d', 'f', 'H', ...) of a buffer's format, or 0 if its items
+// are not single values in native byte order.
+char buffer_type(char const *format);
+
+// Buffer exports of the Datasets and Assignments a function uses while it
+// releases the GIL. While they are held, another thread cannot reinitialize
+// those objects (which would free memory in use); they are released when the
+// BufferHolds goes out of scope, which must be with the GIL held.
+class BufferHolds {
+    public:
+        BufferHolds() : count(0) {}
+        ~BufferHolds() {
+            for (int i = 0; i < count; ++i) {
+                PyBuffer_Release(&views[i]);
+            }
+        }
+
+        // Hold obj (if not NULL) with the given PyBUF_ flags. On failure, set
+        // a Python exception and return false.
+        bool hold(PyObject *obj, int flags) {
+            if (obj == NULL) {
+                return true;
+            }
+            if (PyObject_GetBuffer(obj, &views[count], flags) < 0) {
+                return false;
+            }
+            ++count;
+            return true;
+        }
+
+    private:
+        static const int MAX_HOLDS = 8;
+        Py_buffer views[MAX_HOLDS];
+        int count;
+
+        // Disallow copies.
+        BufferHolds(BufferHolds const &);
+        BufferHolds const &operator=(BufferHolds const &);
+};
+
 #endif
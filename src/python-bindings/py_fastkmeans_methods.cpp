@@ -4,6 +4,7 @@
 
 #include "py_fastkmeans_methods.h"
 
+#include "center_seeding.h"
 #include "general_functions.h"
 #include "py_assignment.h"
 #include "py_dataset.h"
@@ -23,6 +24,10 @@ static PyObject * Fastkmeans_center_dataset(PyObject *self, PyObject *args) {
     }
 
     DatasetObject *d = (DatasetObject *) obj;
+    if (d->view.obj != NULL && d->view.readonly) {
+        PyErr_SetString(PyExc_TypeError, "dataset is read-only");
+        return NULL;
+    }
     centerDataset(d->dataset);
 
     Py_RETURN_NONE;
@@ -36,15 +41,18 @@ static PyObject * init_centers_with_func(PyObject *self, PyObject *args,
         return NULL;
     }
 
-    DatasetObject *d = (DatasetObject *) obj;
-    Dataset *centers = init_func(*(d->dataset), k);
+    BufferHolds holds;
+    if (!holds.hold(obj, PyBUF_SIMPLE)) {
+        return NULL;
+    }
 
-    PyObject *val = Py_BuildValue("ii", centers->n, centers->d);
-    DatasetObject *c = (DatasetObject *)
-        PyObject_CallObject((PyObject *) &DatasetType, val);
-    c->dataset = centers;
+    DatasetObject *d = (DatasetObject *) obj;
+    Dataset *centers;
+    Py_BEGIN_ALLOW_THREADS
+    centers = init_func(*(d->dataset), k);
+    Py_END_ALLOW_THREADS
 
-    return (PyObject *) c;
+    return Dataset_wrap(centers);
 }
 
 static PyObject * Fastkmeans_init_centers_rand(PyObject *self, PyObject *args) {
@@ -67,26 +75,165 @@ static PyObject * Fastkmeans_kmeans_plusplus_v2(PyObject *self,
     return init_centers_with_func(self, args, init_centers_kmeanspp_v2);
 }
 
+static PyObject * Fastkmeans_afkmc2(PyObject *self, PyObject *args,
+        PyObject *kwargs) {
+    // afkmc2(a_dataset, k, chain_length=200)
+
+    PyObject *obj;
+    unsigned short k;
+    int chainLength = 200;
+
+    char *emptyStr = const_cast<char *>("");
+    char *kwlist[] = {emptyStr, emptyStr, const_cast<char *>("chain_length"),
+        NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!H|i", kwlist,
+                &DatasetType, &obj, &k, &chainLength)) {
+        return NULL;
+    }
+
+    BufferHolds holds;
+    if (!holds.hold(obj, PyBUF_SIMPLE)) {
+        return NULL;
+    }
+
+    DatasetObject *d = (DatasetObject *) obj;
+    Dataset *centers;
+    Py_BEGIN_ALLOW_THREADS
+    centers = init_centers_afkmc2(*(d->dataset), k, chainLength);
+    Py_END_ALLOW_THREADS
+
+    return Dataset_wrap(centers);
+}
+
+static PyObject * Fastkmeans_kmeans_parallel(PyObject *self, PyObject *args,
+        PyObject *kwargs) {
+    // kmeans_parallel(a_dataset, k, num_threads=1, rounds=5, oversampling=0.0)
+
+    PyObject *obj;
+    unsigned short k;
+    int numThreads = 1;
+    int rounds = 5;
+    double oversampling = 0.0;
+
+    char *emptyStr = const_cast<char *>("");
+    char *kwlist[] = {emptyStr, emptyStr, const_cast<char *>("num_threads"),
+        const_cast<char *>("rounds"), const_cast<char *>("oversampling"),
+        NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!H|iid", kwlist,
+                &DatasetType, &obj, &k, &numThreads, &rounds, &oversampling)) {
+        return NULL;
+    }
+
+    BufferHolds holds;
+    if (!holds.hold(obj, PyBUF_SIMPLE)) {
+        return NULL;
+    }
+
+    DatasetObject *d = (DatasetObject *) obj;
+    Dataset *centers;
+    Py_BEGIN_ALLOW_THREADS
+    centers = init_centers_kmeansparallel(*(d->dataset), k, numThreads,
+            rounds, oversampling);
+    Py_END_ALLOW_THREADS
+
+    return Dataset_wrap(centers);
+}
+
+static PyObject * Fastkmeans_kmeans_plusplus_fast(PyObject *self,
+        PyObject *args, PyObject *kwargs) {
+    // kmeans_plusplus_fast(a_dataset, k, num_threads=1)
+
+    PyObject *obj;
+    unsigned short k;
+    int numThreads = 1;
+
+    char *emptyStr = const_cast<char *>("");
+    char *kwlist[] = {emptyStr, emptyStr, const_cast<char *>("num_threads"),
+        NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!H|i", kwlist,
+                &DatasetType, &obj, &k, &numThreads)) {
+        return NULL;
+    }
+
+    BufferHolds holds;
+    if (!holds.hold(obj, PyBUF_SIMPLE)) {
+        return NULL;
+    }
+
+    DatasetObject *d = (DatasetObject *) obj;
+    Dataset *centers;
+    Py_BEGIN_ALLOW_THREADS
+    centers = init_centers_kmeanspp_fast(*(d->dataset), k, numThreads);
+    Py_END_ALLOW_THREADS
+
+    return Dataset_wrap(centers);
+}
+
 static PyObject * Fastkmeans_get_memory_usage(PyObject *self) {
     // get_memory_usage()
 
     return PyFloat_FromDouble(getMemoryUsage());
 }
 
-static PyObject * Fastkmeans_assign(PyObject *self, PyObject *args) {
-    // assign(dataset, centers, assignment)
+static PyObject * Fastkmeans_assign(PyObject *self, PyObject *args,
+        PyObject *kwargs) {
+    // assign(dataset, centers, assignment, num_threads=1, distances=None,
+    //        second=None)
 
-    PyObject *x, *c, *a;
-    if (!PyArg_ParseTuple(args, "O!O!O!", &DatasetType, &x, &DatasetType, &c,
-                &AssignmentType, &a)) {
+    PyObject *x, *c, *a, *dist = NULL, *sec = NULL;
+    int numThreads = 1;
+
+    char *emptyStr = const_cast<char *>("");
+    char *kwlist[] = {emptyStr, emptyStr, emptyStr,
+        const_cast<char *>("num_threads"), const_cast<char *>("distances"),
+        const_cast<char *>("second"), NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!O!|iO!O!", kwlist,
+                &DatasetType, &x, &DatasetType, &c, &AssignmentType, &a,
+                &numThreads, &DatasetType, &dist, &AssignmentType, &sec)) {
         return NULL;
     }
 
     DatasetObject *dataset = (DatasetObject *) x;
     DatasetObject *centers = (DatasetObject *) c;
     AssignmentObject *assignment = (AssignmentObject *) a;
+    DatasetObject *distances = (DatasetObject *) dist;
+    AssignmentObject *second = (AssignmentObject *) sec;
+
+    int n = dataset->dataset->n;
+    if (assignment->n != n || (second && second->n != n)) {
+        PyErr_SetString(PyExc_ValueError, "assignments must have one entry "
+                "per record");
+        return NULL;
+    }
+    if (centers->dataset->d != dataset->dataset->d) {
+        PyErr_SetString(PyExc_ValueError, "the centers must have the "
+                "dimension of the dataset");
+        return NULL;
+    }
+    if (distances && distances->dataset->n * distances->dataset->d != n) {
+        PyErr_SetString(PyExc_ValueError, "distances must have one entry per "
+                "record");
+        return NULL;
+    }
+    if (distances && distances->view.obj != NULL && distances->view.readonly) {
+        PyErr_SetString(PyExc_TypeError, "distances is read-only");
+        return NULL;
+    }
+
+    BufferHolds holds;
+    if (!holds.hold(x, PyBUF_SIMPLE) || !holds.hold(c, PyBUF_SIMPLE) ||
+            !holds.hold(a, PyBUF_WRITABLE) ||
+            !holds.hold(dist, PyBUF_WRITABLE) ||
+            !holds.hold(sec, PyBUF_WRITABLE)) {
+        return NULL;
+    }
 
-    assign(*(dataset->dataset), *(centers->dataset), assignment->assignment);
+    // let other Python threads run while assigning
+    Py_BEGIN_ALLOW_THREADS
+    assign(*(dataset->dataset), *(centers->dataset), assignment->assignment,
+            numThreads, distances ? distances->dataset->data : NULL,
+            second ? second->assignment : NULL);
+    Py_END_ALLOW_THREADS
 
     Py_RETURN_NONE;
 }
@@ -111,8 +258,25 @@ PyMethodDef Fastkmeans_methods[] = {
         "Initialize the centers randomly using K-means++."},
     {"kmeans_plusplus_v2", (PyCFunction) Fastkmeans_kmeans_plusplus_v2,
         METH_VARARGS, "Initialize the centers randomly using K-means++."},
+    {"afkmc2", (PyCFunction) Fastkmeans_afkmc2, METH_VARARGS | METH_KEYWORDS,
+        "Initialize the centers using AFK-MC^2, which approximates K-means++ "
+        "with a Markov chain of the given length per center."},
+    {"kmeans_parallel", (PyCFunction) Fastkmeans_kmeans_parallel,
+        METH_VARARGS | METH_KEYWORDS,
+        "Initialize the centers using k-means|| (scalable K-means++), with "
+        "the given number of threads, sampling rounds, and oversampling "
+        "factor (2k if not positive)."},
+    {"kmeans_plusplus_fast", (PyCFunction) Fastkmeans_kmeans_plusplus_fast,
+        METH_VARARGS | METH_KEYWORDS,
+        "Initialize the centers using exact K-means++, accelerated with the "
+        "triangle inequality and a sum-tree sampler, with the given number "
+        "of threads."},
     {"get_memory_usage", (PyCFunction) Fastkmeans_get_memory_usage, METH_NOARGS,
         ""},
-    {"assign", (PyCFunction) Fastkmeans_assign, METH_VARARGS, ""},
+    {"assign", (PyCFunction) Fastkmeans_assign, METH_VARARGS | METH_KEYWORDS,
+        "Assign each record to its closest center, with the given number of "
+        "threads; optionally also fill in the distance to that center (a "
+        "Dataset with one entry per record) and the second-closest center (an "
+        "Assignment)."},
     {NULL} // Sentinel
 };
@@ -0,0 +1,764 @@
+/* Kmeans wrappers. The comment at the beginning of each function definition
+ * demonstrates its usage in Python.
+ */
+
+#include "py_kmeans.h"
+
+#include <cstring> // For strcmp
+
+#include "py_assignment.h"
+#include "py_dataset.h"
+
+#include "annulus_kmeans.h"
+#include "compare_kmeans.h"
+#include "drake_kmeans.h"
+#include "elkan_kernel_kmeans.h"
+#include "elkan_kmeans.h"
+#include "hamerly_kernel_kmeans.h"
+#include "hamerly_kmeans.h"
+#include "heap_kmeans.h"
+#include "kdtree_kmeans.h"
+#include "minibatch_kmeans.h"
+#include "naive_kernel_kmeans.h"
+#include "naive_kmeans.h"
+#include "sort_kmeans.h"
+
+
+// Helper functions
+
+
+// Drop the buffer exports of the dataset and assignment, if any.
+static void Kmeans_release_buffers(KmeansObject *self) {
+    if (self->dataset.obj != NULL) {
+        PyBuffer_Release(&self->dataset);
+    }
+    if (self->assignment.obj != NULL) {
+        PyBuffer_Release(&self->assignment);
+    }
+}
+
+// If run() or initialize() is in progress in another thread, set a Python
+// exception and return true.
+static bool Kmeans_busy(KmeansObject *self) {
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError,
+                "the algorithm is running in another thread");
+        return true;
+    }
+    return false;
+}
+
+// If the algorithm is busy (see Kmeans_busy()) or was never constructed (a
+// subclass whose __init__ did not call the base one), set a Python exception
+// and return true.
+static bool Kmeans_unavailable(KmeansObject *self) {
+    if (Kmeans_busy(self)) {
+        return true;
+    }
+    if (self->instance == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                "the algorithm has not been constructed");
+        return true;
+    }
+    return false;
+}
+
+
+// Object special methods
+
+
+static void Kmeans_dealloc(KmeansObject *self) {
+    delete self->instance;
+    self->instance = NULL;
+    Kmeans_release_buffers(self);
+
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+
+// Object properties
+
+
+static PyObject * Kmeans_get_centers(KmeansObject *self, void *closure) {
+    // a_kmeans.centers
+
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    // Copy the centers to preserve constness (None for the algorithms that
+    // have no explicit centers, such as kernel k-means)
+    return Dataset_copy(self->instance->getCenters());
+}
+
+static PyGetSetDef Kmeans_getsetters[] = {
+    {
+        const_cast<char *>("centers"),
+        (getter) Kmeans_get_centers,
+        NULL, // Setter
+        const_cast<char *>("The set of centers"),
+    },
+    {NULL} // Sentinel
+};
+
+
+// Kmeans methods
+
+
+static PyObject * Kmeans_free(KmeansObject *self) {
+    // a_kmeans.free()
+
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    self->instance->free();
+    Py_RETURN_NONE;
+}
+
+static PyObject * Kmeans_get_name(KmeansObject *self) {
+    // a_kmeans.get_name()
+
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    return PyUnicode_FromString(self->instance->getName().c_str());
+}
+
+static PyObject * Kmeans_point_point_inner_product(KmeansObject *self,
+        PyObject *args) {
+    // a_kmeans.point_point_inner_product(x1, x2)
+
+    int x1ndx, x2ndx;
+    if (!PyArg_ParseTuple(args, "ii", &x1ndx, &x2ndx)) {
+        return NULL;
+    }
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    double innerProd = self->instance->pointPointInnerProduct(x1ndx, x2ndx);
+
+    return PyFloat_FromDouble(innerProd);
+}
+
+static PyObject * Kmeans_point_center_inner_product(KmeansObject *self,
+        PyObject *args) {
+    // a_kmeans.point_center_inner_product(xndx, cndx)
+
+    int xndx;
+    unsigned short cndx;
+    if (!PyArg_ParseTuple(args, "iH", &xndx, &cndx)) {
+        return NULL;
+    }
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    double innerProd = self->instance->pointCenterInnerProduct(xndx, cndx);
+
+    return PyFloat_FromDouble(innerProd);
+}
+
+static PyObject * Kmeans_center_center_inner_product(KmeansObject *self,
+        PyObject *args) {
+    // a_kmeans.center_center_inner_product(c1, c2)
+
+    unsigned short c1, c2;
+    if (!PyArg_ParseTuple(args, "HH", &c1, &c2)) {
+        return NULL;
+    }
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    double innerProd = self->instance->centerCenterInnerProduct(c1, c2);
+
+    return PyFloat_FromDouble(innerProd);
+}
+
+static PyObject * Kmeans_run(KmeansObject *self, PyObject *args,
+        PyObject *kwargs) {
+    // a_kmeans.run(max_iterations = 0)
+
+    int maxIterations = 0;
+
+    static char *kwlist[] = {const_cast<char *>("max_iterations"), NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i", kwlist,
+                &maxIterations)) {
+        return NULL;
+    }
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    // let other Python threads run while clustering
+    int numIterations;
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    numIterations = maxIterations > 0 ?
+        self->instance->run(maxIterations) : self->instance->run();
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+
+    return PyLong_FromLong(numIterations);
+}
+
+static PyObject * Kmeans_get_assignment(KmeansObject *self, PyObject *args) {
+    // a_kmeans.get_assignment(xndx)
+
+    int xndx;
+    if (!PyArg_ParseTuple(args, "i", &xndx)) {
+        return NULL;
+    }
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    int assignment = self->instance->getAssignment(xndx);
+
+    return PyLong_FromLong(assignment);
+}
+
+static PyObject * Kmeans_verify_assignment(KmeansObject *self, PyObject *args) {
+    // a_kmeans.verify_assignment(iteration, startndx, endndx)
+
+    int iteration, startNdx, endNdx;
+    if (!PyArg_ParseTuple(args, "iii", &iteration, &startNdx, &endNdx)) {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject * Kmeans_get_sse(KmeansObject *self) {
+    // a_kmeans.get_sse()
+
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    return PyFloat_FromDouble(self->instance->getSSE());
+}
+
+static PyObject * Kmeans_point_center_dist_2(KmeansObject *self, PyObject *args) {
+    // a_kmeans.point_center_dist_2(x1, cndx)
+
+    int x1;
+    unsigned short cndx;
+    if (!PyArg_ParseTuple(args, "iH", &x1, &cndx)) {
+        return NULL;
+    }
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    double dist2 = self->instance->pointCenterDist2(x1, cndx);
+
+    return PyFloat_FromDouble(dist2);
+}
+
+static PyObject * Kmeans_center_center_dist_2(KmeansObject *self, PyObject *args) {
+    // a_kmeans.center_center_dist_2(c1, c2)
+
+    unsigned short c1, c2;
+    if (!PyArg_ParseTuple(args, "HH", &c1, &c2)) {
+        return NULL;
+    }
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    double dist2 = self->instance->centerCenterDist2(c1, c2);
+
+    return PyFloat_FromDouble(dist2);
+}
+
+
+// Kmeans method definitions
+
+
+static PyMethodDef Kmeans_methods[] = {
+    {"run", (PyCFunction) Kmeans_run, METH_VARARGS | METH_KEYWORDS,
+        "Run threads until convergence or max iters, and returns num iters"},
+    {"free", (PyCFunction) Kmeans_free, METH_NOARGS, "Free the object's memory"},
+    {"point_point_inner_product",
+        (PyCFunction) Kmeans_point_point_inner_product,
+        METH_VARARGS,
+        "Compute inner product. Could be standard dot operator, or kernel "
+            "function for more exotic applications."},
+    {"point_center_inner_product",
+        (PyCFunction) Kmeans_point_center_inner_product,
+        METH_VARARGS,
+        "Compute inner product. Could be standard dot operator, or kernel "
+            "function for more exotic applications."},
+    {"center_center_inner_product",
+        (PyCFunction) Kmeans_center_center_inner_product,
+        METH_VARARGS,
+        "Compute inner product. Could be standard dot operator, or kernel "
+            "function for more exotic applications."},
+    {"point_center_dist_2", (PyCFunction) Kmeans_point_center_dist_2,
+        METH_VARARGS,
+        "Use the inner products to computer squared distances between a point "
+            "and center."},
+    {"center_center_dist_2", (PyCFunction) Kmeans_center_center_dist_2,
+        METH_VARARGS,
+        "Use the inner products to computer squared distances between two "
+            "centers."},
+    {"get_assignment", (PyCFunction) Kmeans_get_assignment, METH_VARARGS,
+        "Get the cluster assignment for the given point index"},
+    {"verify_assignment", (PyCFunction) Kmeans_verify_assignment, METH_VARARGS,
+        "Verify that current assignment is correct, by checking every "
+            "point-center distance. For debugging."},
+    {"get_sse", (PyCFunction) Kmeans_get_sse, METH_NOARGS,
+        "Return the sum of squared errors for each cluster"},
+    {"get_name", (PyCFunction) Kmeans_get_name, METH_NOARGS,
+        "Return the algorithm name"},
+    {NULL} // Sentinel
+};
+
+
+// Kmeans type object
+
+
+PyTypeObject KmeansType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "fastkmeans.Kmeans", // tp_name
+    sizeof(KmeansObject), // tp_basicsize
+    0, // tp_itemsize
+
+    (destructor) Kmeans_dealloc, // tp_dealloc
+    NULL, // tp_print
+    NULL, // tp_getattr
+    NULL, // tp_setattr
+    NULL, // tp_as_sync
+    NULL, // tp_repr
+
+    NULL, // tp_as_number
+    NULL, // tp_as_sequence
+    NULL, // tp_as_mapping
+
+    NULL, // tp_hash
+    NULL, // tp_call
+    NULL, // tp_str
+    NULL, // tp_getattro
+    NULL, // tp_setattro
+
+    NULL, // tp_as_buffer
+
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, // tp_flags
+
+    "Base class of the k-means algorithms", // tp_doc
+
+    NULL, // tp_traverse
+
+    NULL, // tp_clear
+
+    NULL, // tp_richcompare
+
+    0, // tp_weaklistoffset
+
+    NULL, // tp_iter
+    NULL, // tp_iternext
+
+    Kmeans_methods, // tp_methods
+    NULL, // tp_members
+    Kmeans_getsetters, // tp_getset
+    NULL, // tp_base
+    NULL, // tp_dict
+    NULL, // tp_descr_get
+    NULL, // tp_descr_set
+    0, // tp_dictoffset
+    NULL, // tp_init
+    PyType_GenericAlloc, // tp_alloc
+    NULL, // tp_new: only the algorithm types can be instantiated
+    NULL, // tp_free
+    NULL, // tp_is_gc
+    NULL, // tp_bases
+    NULL, // tp_mro
+    NULL, // tp_cache
+    NULL, // tp_subclasses
+    NULL, // tp_weaklist
+    NULL, // tp_del
+
+    0, // tp_version_tag
+    NULL, // tp_finalize
+};
+
+
+// Algorithm construction
+
+
+// Drake's algorithm, choosing its number of bounds from k at initialize().
+class AdaptiveKmeans : public DrakeKmeans {
+    public:
+        AdaptiveKmeans() : DrakeKmeans(ADAPTIVE) {}
+};
+
+// Make an algorithm of type T from the arguments of its Python constructor,
+// or set a Python exception and return NULL. By default the constructor
+// takes no arguments.
+template <class T>
+static Kmeans * create(PyObject *args, PyObject *kwargs) {
+    // an_algorithm = Naive()
+
+    static char *kwlist[] = {NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "", kwlist)) {
+        return NULL;
+    }
+
+    return new T();
+}
+
+// Make a triangle inequality algorithm that may use a center index.
+template <class T>
+static Kmeans * create_indexed(PyObject *args, PyObject *kwargs) {
+    // an_algorithm = Hamerly(use_center_index=False)
+
+    int useCenterIndex = 0;
+
+    static char *kwlist[] = {const_cast<char *>("use_center_index"), NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p", kwlist,
+                &useCenterIndex)) {
+        return NULL;
+    }
+
+    T *algorithm = new T();
+    algorithm->setUseCenterIndex(useCenterIndex);
+    return algorithm;
+}
+
+template <>
+Kmeans * create<HamerlyKmeans>(PyObject *args, PyObject *kwargs) {
+    return create_indexed<HamerlyKmeans>(args, kwargs);
+}
+
+template <>
+Kmeans * create<AnnulusKmeans>(PyObject *args, PyObject *kwargs) {
+    return create_indexed<AnnulusKmeans>(args, kwargs);
+}
+
+template <>
+Kmeans * create<AdaptiveKmeans>(PyObject *args, PyObject *kwargs) {
+    return create_indexed<AdaptiveKmeans>(args, kwargs);
+}
+
+template <>
+Kmeans * create<DrakeKmeans>(PyObject *args, PyObject *kwargs) {
+    // a_drake = Drake(num_bounds, use_center_index=False)
+
+    int numBounds;
+    int useCenterIndex = 0;
+
+    char *emptyStr = const_cast<char *>("");
+    char *kwlist[] = {emptyStr, const_cast<char *>("use_center_index"), NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|p", kwlist,
+                &numBounds, &useCenterIndex)) {
+        return NULL;
+    }
+
+    if (numBounds < 1) {
+        PyErr_SetString(PyExc_ValueError,
+                "Drake needs at least one lower bound");
+        return NULL;
+    }
+
+    DrakeKmeans *algorithm = new DrakeKmeans(numBounds);
+    algorithm->setUseCenterIndex(useCenterIndex);
+    return algorithm;
+}
+
+template <>
+Kmeans * create<MiniBatchKmeans>(PyObject *args, PyObject *kwargs) {
+    // a_minibatch = MiniBatch(batch_size=1000, patience=10)
+
+    int batchSize = 1000;
+    int patience = 10;
+
+    char *kwlist[] = {const_cast<char *>("batch_size"),
+        const_cast<char *>("patience"), NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ii", kwlist,
+                &batchSize, &patience)) {
+        return NULL;
+    }
+
+    if (batchSize < 1 || patience < 0) {
+        PyErr_SetString(PyExc_ValueError,
+                "batch_size must be positive and patience non-negative");
+        return NULL;
+    }
+
+    return new MiniBatchKmeans(batchSize, patience);
+}
+
+// Make a kernel k-means algorithm. The kernel is named by the first argument
+// and followed by its parameters: 'linear', 'gaussian' with the bandwidth tau,
+// or 'polynomial' with the constant added and the power. The other arguments
+// are those of the driver's kernelcache, kernelincremental and kernelcutoff
+// commands.
+template <class T>
+static Kmeans * create_kernel(PyObject *args, PyObject *kwargs) {
+    // an_algorithm = NaiveKernel('gaussian', tau, cache_mb=0,
+    //                            incremental=True, cutoff=0)
+    // an_algorithm = NaiveKernel('polynomial', add, power)
+    // an_algorithm = NaiveKernel('linear')
+
+    char const *kernelType;
+    double parameters[2] = {0.0, 0.0};
+    double cacheMB = 0.0;
+    int incremental = 1;
+    double cutoff = 0.0;
+
+    char *emptyStr = const_cast<char *>("");
+    char *kwlist[] = {emptyStr, emptyStr, emptyStr,
+        const_cast<char *>("cache_mb"), const_cast<char *>("incremental"),
+        const_cast<char *>("cutoff"), NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|dd$dpd", kwlist,
+                &kernelType, &parameters[0], &parameters[1], &cacheMB,
+                &incremental, &cutoff)) {
+        return NULL;
+    }
+    Py_ssize_t numParameters = PyTuple_GET_SIZE(args) - 1;
+
+    if (cacheMB < 0.0 || cutoff < 0.0 || cutoff >= 1.0) {
+        PyErr_SetString(PyExc_ValueError,
+                "cache_mb must be non-negative and cutoff in [0, 1)");
+        return NULL;
+    }
+
+    Kernel const *kernel = NULL;
+    if (strcmp(kernelType, "linear") == 0 && numParameters == 0) {
+        kernel = new LinearKernel;
+    } else if (strcmp(kernelType, "gaussian") == 0 && numParameters == 1 &&
+            parameters[0] > 0.0) {
+        kernel = new GaussianKernel(parameters[0]);
+    } else if (strcmp(kernelType, "polynomial") == 0 && numParameters == 2) {
+        kernel = new PolynomialKernel(parameters[0], parameters[1]);
+    } else {
+        PyErr_SetString(PyExc_ValueError,
+                "the kernel must be 'linear', 'gaussian' with a positive tau, "
+                "or 'polynomial' with the constant added and the power");
+        return NULL;
+    }
+
+    // the algorithm owns the kernel
+    T *algorithm = new T(kernel);
+    algorithm->setKernelCacheSize((size_t)(cacheMB * 1024 * 1024));
+    algorithm->setIncremental(incremental);
+    algorithm->setKernelThreshold(cutoff);
+    return algorithm;
+}
+
+template <>
+Kmeans * create<NaiveKernelKmeans>(PyObject *args, PyObject *kwargs) {
+    return create_kernel<NaiveKernelKmeans>(args, kwargs);
+}
+
+template <>
+Kmeans * create<ElkanKernelKmeans>(PyObject *args, PyObject *kwargs) {
+    return create_kernel<ElkanKernelKmeans>(args, kwargs);
+}
+
+template <>
+Kmeans * create<HamerlyKernelKmeans>(PyObject *args, PyObject *kwargs) {
+    return create_kernel<HamerlyKernelKmeans>(args, kwargs);
+}
+
+// Whether an algorithm of type T can find k clusters; if not, set a Python
+// exception and return false.
+template <class T>
+static bool check(T const *algorithm, unsigned short k) {
+    return true;
+}
+
+static bool check_drake(DrakeKmeans const *algorithm, unsigned short k) {
+    int numBounds = algorithm->getNumBounds(k);
+    if (numBounds < 1 || k <= numBounds) {
+        PyErr_Format(PyExc_ValueError,
+                "Drake cannot use %d lower bounds with %d centers",
+                numBounds, (int) k);
+        return false;
+    }
+    return true;
+}
+
+template <>
+bool check<DrakeKmeans>(DrakeKmeans const *algorithm, unsigned short k) {
+    return check_drake(algorithm, k);
+}
+
+template <>
+bool check<AdaptiveKmeans>(AdaptiveKmeans const *algorithm, unsigned short k) {
+    return check_drake(algorithm, k);
+}
+
+
+// Algorithm special methods and methods
+
+
+template <class T>
+static int Algorithm_init(KmeansObject *self, PyObject *args,
+        PyObject *kwargs) {
+    // an_algorithm = Naive() (see create() for the arguments)
+
+    if (Kmeans_busy(self)) {
+        return -1;
+    }
+
+    Kmeans *instance = create<T>(args, kwargs);
+    if (instance == NULL) {
+        return -1;
+    }
+
+    delete self->instance;
+    self->instance = instance;
+    Kmeans_release_buffers(self);
+
+    return 0;
+}
+
+template <class T>
+static PyObject * Algorithm_initialize(KmeansObject *self, PyObject *args,
+        PyObject *kwargs) {
+    // an_algorithm.initialize(x, k, initial_assignment, num_threads=an_int)
+
+    PyObject *x_orig, *initAssigns_orig;
+    unsigned short k;
+    int numThreads = 1;
+
+    char *emptyStr = const_cast<char *>("");
+    char *kwlist[] = {emptyStr, emptyStr, emptyStr,
+        const_cast<char *>("num_threads"), NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!HO!|i", kwlist,
+                &DatasetType, &x_orig, &k, &AssignmentType, &initAssigns_orig,
+                &numThreads)) {
+        return NULL;
+    }
+
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    T *instance = static_cast<T *>(self->instance);
+    if (!check<T>(instance, k)) {
+        return NULL;
+    }
+
+    // Hold buffer exports of the dataset and assignment while the algorithm
+    // uses them (the dataset is only read, so it may be read-only)
+    Py_buffer datasetView, assignmentView;
+    if (PyObject_GetBuffer(x_orig, &datasetView, PyBUF_SIMPLE) < 0) {
+        return NULL;
+    }
+    if (PyObject_GetBuffer(initAssigns_orig, &assignmentView,
+                PyBUF_WRITABLE) < 0) {
+        PyBuffer_Release(&datasetView);
+        return NULL;
+    }
+    Kmeans_release_buffers(self);
+    self->dataset = datasetView;
+    self->assignment = assignmentView;
+
+    DatasetObject *x = (DatasetObject *) x_orig;
+    AssignmentObject *initAssigns = (AssignmentObject *) initAssigns_orig;
+
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    instance->initialize(x->dataset, k, initAssigns->assignment, numThreads);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+
+    Py_RETURN_NONE;
+}
+
+#define ALGORITHM_INITIALIZE_METHOD(T) \
+    {"initialize", (PyCFunction) Algorithm_initialize<T>, \
+        METH_VARARGS | METH_KEYWORDS, \
+        "Initialize algorithm at beginning of run() with given data and " \
+            "initial_assignment, which will be modified to contain final " \
+            "assignment of clusters"}
+
+// The methods of the algorithm type for T, beyond those of Kmeans.
+template <class T>
+static PyMethodDef * algorithm_methods() {
+    static PyMethodDef methods[] = {
+        ALGORITHM_INITIALIZE_METHOD(T),
+        {NULL} // Sentinel
+    };
+    return methods;
+}
+
+static PyObject * MiniBatch_get_ewa_objective(KmeansObject *self) {
+    // a_minibatch.get_ewa_objective()
+
+    if (Kmeans_unavailable(self)) {
+        return NULL;
+    }
+
+    MiniBatchKmeans *instance = static_cast<MiniBatchKmeans *>(self->instance);
+    return PyFloat_FromDouble(instance->getEwaObjective());
+}
+
+template <>
+PyMethodDef * algorithm_methods<MiniBatchKmeans>() {
+    static PyMethodDef methods[] = {
+        ALGORITHM_INITIALIZE_METHOD(MiniBatchKmeans),
+        {"get_ewa_objective", (PyCFunction) MiniBatch_get_ewa_objective,
+            METH_NOARGS,
+            "Return the smoothed (EWA) batch objective after the last batch"},
+        {NULL} // Sentinel
+    };
+    return methods;
+}
+
+
+// Algorithm type objects
+
+
+// The type named name (fastkmeans.Name) for algorithms of type T.
+template <class T>
+static PyTypeObject algorithm_type(char const *name, char const *doc) {
+    PyTypeObject type = {PyVarObject_HEAD_INIT(NULL, 0)};
+    type.tp_name = name;
+    type.tp_basicsize = sizeof(KmeansObject);
+    type.tp_dealloc = (destructor) Kmeans_dealloc;
+    type.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+    type.tp_doc = doc;
+    type.tp_methods = algorithm_methods<T>();
+    type.tp_base = &KmeansType;
+    type.tp_init = (initproc) Algorithm_init<T>;
+    type.tp_alloc = PyType_GenericAlloc;
+    type.tp_new = PyType_GenericNew;
+    return type;
+}
+
+PyTypeObject AdaptiveType = algorithm_type<AdaptiveKmeans>(
+        "fastkmeans.Adaptive", "Drake's algorithm with k/4 lower bounds");
+PyTypeObject AnnulusType = algorithm_type<AnnulusKmeans>(
+        "fastkmeans.Annulus", "Hamerly's algorithm searching centers by norm");
+PyTypeObject CompareType = algorithm_type<CompareKmeans>(
+        "fastkmeans.Compare", "Phillips' Compare-Means algorithm");
+PyTypeObject DrakeType = algorithm_type<DrakeKmeans>(
+        "fastkmeans.Drake", "Drake's algorithm with a given number of bounds");
+PyTypeObject ElkanType = algorithm_type<ElkanKmeans>(
+        "fastkmeans.Elkan", "Elkan's algorithm");
+PyTypeObject HamerlyType = algorithm_type<HamerlyKmeans>(
+        "fastkmeans.Hamerly", "Hamerly's algorithm");
+PyTypeObject HeapType = algorithm_type<HeapKmeans>(
+        "fastkmeans.Heap", "The heap algorithm, with a heap of points per cluster");
+PyTypeObject KdTreeType = algorithm_type<KdTreeKmeans>(
+        "fastkmeans.KdTree", "The filtering algorithm of Kanungo et al. over a kd-tree");
+PyTypeObject MiniBatchType = algorithm_type<MiniBatchKmeans>(
+        "fastkmeans.MiniBatch", "Mini-batch k-means");
+PyTypeObject NaiveType = algorithm_type<NaiveKmeans>(
+        "fastkmeans.Naive", "Lloyd's algorithm");
+PyTypeObject SortType = algorithm_type<SortKmeans>(
+        "fastkmeans.Sort", "Phillips' Sort-Means algorithm");
+
+PyTypeObject ElkanKernelType = algorithm_type<ElkanKernelKmeans>(
+        "fastkmeans.ElkanKernel", "Kernel k-means with Elkan's bounds");
+PyTypeObject HamerlyKernelType = algorithm_type<HamerlyKernelKmeans>(
+        "fastkmeans.HamerlyKernel", "Kernel k-means with Hamerly's bounds");
+PyTypeObject NaiveKernelType = algorithm_type<NaiveKernelKmeans>(
+        "fastkmeans.NaiveKernel", "Kernel k-means");
@@ -0,0 +1,56 @@
+#ifndef PY_KMEANS_H
+#define PY_KMEANS_H
+
+/* Provides wrappers for the Kmeans algorithms. See kmeans.h for more detail.
+ *
+ * fastkmeans.Kmeans is the base type of all of them, and holds the methods
+ * they share, which call the algorithm through the Kmeans interface. Each
+ * algorithm type is made by the same templates in py_kmeans.cpp from how to
+ * construct the algorithm from Python arguments; it adds initialize() (which
+ * may check the arguments against the algorithm) and any methods particular
+ * to the algorithm.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include "kmeans.h"
+
+typedef struct {
+    PyObject_HEAD
+    Kmeans *instance;
+
+    // Buffer exports of the Dataset and Assignment given to initialize(),
+    // held until the next initialize() or deallocation, so that they cannot
+    // be reinitialized (freeing memory the algorithm uses) in the meantime.
+    // view.obj is NULL when there is none.
+    Py_buffer dataset;
+    Py_buffer assignment;
+
+    // Whether run() or initialize() is in progress; they release the GIL, so
+    // other Python threads may call methods meanwhile.
+    int busy;
+} KmeansObject;
+
+// The base type, which cannot be instantiated.
+extern PyTypeObject KmeansType;
+
+// Lloyd's algorithm and the accelerated algorithms.
+extern PyTypeObject AdaptiveType;
+extern PyTypeObject AnnulusType;
+extern PyTypeObject CompareType;
+extern PyTypeObject DrakeType;
+extern PyTypeObject ElkanType;
+extern PyTypeObject HamerlyType;
+extern PyTypeObject HeapType;
+extern PyTypeObject KdTreeType;
+extern PyTypeObject MiniBatchType;
+extern PyTypeObject NaiveType;
+extern PyTypeObject SortType;
+
+// The kernel k-means algorithms.
+extern PyTypeObject ElkanKernelType;
+extern PyTypeObject HamerlyKernelType;
+extern PyTypeObject NaiveKernelType;
+
+#endif
@@ -43,12 +43,15 @@ a = Assignment(n)
 # Initialize and run each algorithm
 
 algorithms = (
+    Adaptive,
     Annulus,
     Compare,
     Drake,
     Elkan,
     Hamerly,
     Heap,
+    KdTree,
+    MiniBatch,
     Naive,
     Sort,
 )
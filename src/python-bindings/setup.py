@@ -43,21 +43,17 @@ setup(
             'fastkmeans',
             [
                 'fastkmeans.cpp',
-                'py_annulus.cpp',
                 'py_assignment.cpp',
-                'py_compare.cpp',
+                'py_center_index.cpp',
                 'py_dataset.cpp',
-                'py_drake.cpp',
-                'py_elkan.cpp',
-                'py_hamerly.cpp',
-                'py_heap.cpp',
                 'py_fastkmeans_methods.cpp',
-                'py_naive.cpp',
-                'py_sort.cpp',
+                'py_kmeans.cpp',
             ],
             include_dirs = ['..'],
-            library_dirs=['..'],
-            libraries=['kmeans'],
+            # the threaded build of the library made by 'make python-module'
+            library_dirs=['build/kmeans'],
+            libraries=['kmeans_threads', 'pthread'],
+            define_macros=[('USE_THREADS', None)],
         ),
     ]
 )
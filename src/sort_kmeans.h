@@ -17,6 +17,7 @@ class SortKmeans : public OriginalSpaceKmeans {
         SortKmeans() : sortedCenters(NULL) {}
         virtual ~SortKmeans() { free(); }
         virtual void free();
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
         virtual std::string getName() const { return "sort"; }
 
@@ -0,0 +1,464 @@
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ */
+
+#include "streaming_kmeans.h"
+#include "general_functions.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+StreamingKmeans::StreamingKmeans(bool aCompressBounds) : source(NULL), n(0),
+    k(0), d(0), numThreads(0), compressBounds(aCompressBounds), centers(NULL),
+    sumNewCenters(NULL), clusterSize(NULL), centerMovement(NULL), s(NULL),
+    assignment(NULL), upperD(NULL), lowerD(NULL), upperF(NULL), lowerF(NULL),
+    converged(false), moreChunks(false), readFailed(false), currentBuffer(-1), chunkStart(0),
+    chunkCount(0), nextBuffer(0) {
+    buffer[0] = buffer[1] = NULL;
+}
+
+void StreamingKmeans::free() {
+    for (int t = 0; t < numThreads; ++t) {
+        delete [] sumNewCenters[t];
+        delete [] clusterSize[t];
+    }
+    delete [] sumNewCenters;
+    delete [] clusterSize;
+    delete centers;
+    delete [] centerMovement;
+    delete [] s;
+    delete [] assignment;
+    delete [] upperD;
+    delete [] lowerD;
+    delete [] upperF;
+    delete [] lowerF;
+    delete [] buffer[0];
+    delete [] buffer[1];
+    sumNewCenters = NULL;
+    clusterSize = NULL;
+    centers = NULL;
+    centerMovement = s = NULL;
+    assignment = NULL;
+    upperD = lowerD = NULL;
+    upperF = lowerF = NULL;
+    buffer[0] = buffer[1] = NULL;
+    source = NULL;
+    n = k = d = numThreads = 0;
+}
+
+void StreamingKmeans::initialize(ChunkedDataset *aSource, Dataset const &initialCenters, int aNumThreads) {
+    free();
+
+    source = aSource;
+    n = source->n;
+    d = source->d;
+    k = initialCenters.n;
+    #ifdef USE_THREADS
+    numThreads = aNumThreads;
+    #else
+    numThreads = 1;
+    #endif
+    converged = false;
+
+    centers = new Dataset(initialCenters);
+    centerMovement = new double[k];
+    s = new double[k];
+    std::fill(s, s + k, 0.0);
+
+    sumNewCenters = new double *[numThreads];
+    clusterSize = new int *[numThreads];
+    for (int t = 0; t < numThreads; ++t) {
+        sumNewCenters[t] = new double[k * d];
+        clusterSize[t] = new int[k];
+        std::fill(sumNewCenters[t], sumNewCenters[t] + k * d, 0.0);
+        std::fill(clusterSize[t], clusterSize[t] + k, 0);
+    }
+
+    // no point is assigned yet, which forces the first pass to look at all
+    // centers for every point
+    assignment = new unsigned short[n];
+    std::fill(assignment, assignment + n, k);
+    if (compressBounds) {
+        upperF = new float[n];
+        lowerF = new float[n];
+    } else {
+        upperD = new double[n];
+        lowerD = new double[n];
+    }
+    for (int i = 0; i < n; ++i) {
+        setUpper(i, std::numeric_limits<double>::max());
+        setLower(i, 0.0);
+    }
+
+    buffer[0] = new double[source->chunkSize * d];
+    buffer[1] = new double[source->chunkSize * d];
+}
+
+void StreamingKmeans::setUpper(int i, double value) {
+    if (! compressBounds) {
+        upperD[i] = value;
+    } else if (value > FLT_MAX) {
+        upperF[i] = INFINITY;
+    } else {
+        // round up, so the bound stays valid
+        upperF[i] = (float)value;
+        if ((double)upperF[i] < value) {
+            upperF[i] = nextafterf(upperF[i], INFINITY);
+        }
+    }
+}
+
+void StreamingKmeans::setLower(int i, double value) {
+    if (! compressBounds) {
+        lowerD[i] = value;
+    } else if (value > FLT_MAX) {
+        lowerF[i] = FLT_MAX;
+    } else if (value < -FLT_MAX) {
+        lowerF[i] = -INFINITY;
+    } else {
+        // round down, so the bound stays valid
+        lowerF[i] = (float)value;
+        if (value < (double)lowerF[i]) {
+            lowerF[i] = nextafterf(lowerF[i], -INFINITY);
+        }
+    }
+}
+
+#ifdef USE_THREADS
+struct StreamingThreadInfo {
+    StreamingKmeans *km;
+    int threadId, maxIterations, numIterations;
+    pthread_t pthread_id;
+};
+#endif
+
+void *StreamingKmeans::runner(void *args) {
+    #ifdef USE_THREADS
+    StreamingThreadInfo *ti = (StreamingThreadInfo *)args;
+    ti->numIterations = ti->km->runThread(ti->threadId, ti->maxIterations);
+    #endif
+    return NULL;
+}
+
+int StreamingKmeans::run(int maxIterations) {
+    int iterations = 0;
+
+    source->rewind();
+    currentBuffer = -1;
+    nextBuffer = 0;
+    chunkStart = chunkCount = 0;
+    readFailed = false;
+
+    #ifdef USE_THREADS
+    {
+        full[0] = full[1] = false;
+        stopReading = false;
+        pthread_mutex_init(&bufferLock, NULL);
+        pthread_cond_init(&bufferChanged, NULL);
+        pthread_barrier_init(&barrier, NULL, numThreads);
+        pthread_create(&readerThread, NULL, StreamingKmeans::reader, this);
+
+        StreamingThreadInfo *info = new StreamingThreadInfo[numThreads];
+        for (int t = 0; t < numThreads; ++t) {
+            info[t].km = this;
+            info[t].threadId = t;
+            info[t].maxIterations = maxIterations;
+            pthread_create(&info[t].pthread_id, NULL, StreamingKmeans::runner, &info[t]);
+        }
+        for (int t = 0; t < numThreads; ++t) {
+            pthread_join(info[t].pthread_id, NULL);
+        }
+        iterations = info[0].numIterations;
+        delete [] info;
+
+        // stop the reader, which may be waiting for a free buffer
+        pthread_mutex_lock(&bufferLock);
+        stopReading = true;
+        pthread_cond_broadcast(&bufferChanged);
+        pthread_mutex_unlock(&bufferLock);
+        pthread_join(readerThread, NULL);
+
+        pthread_barrier_destroy(&barrier);
+        pthread_cond_destroy(&bufferChanged);
+        pthread_mutex_destroy(&bufferLock);
+    }
+    #else
+    {
+        iterations = runThread(0, maxIterations);
+    }
+    #endif
+
+    return readFailed ? -1 : iterations;
+}
+
+/* Each iteration is one pass over the data. Thread 0 fetches each chunk in
+ * turn, and all threads assign their share of it; then thread 0 moves the
+ * centers, and all threads update the bounds of their share of the points.
+ *
+ * Parameters:
+ *   - threadId: the index of the thread that is running
+ *   - maxIterations: a bound on the number of iterations to perform
+ *
+ * Return value: the number of iterations performed
+ */
+int StreamingKmeans::runThread(int threadId, int maxIterations) {
+    int iterations = 0;
+
+    int startNdx = (int)((long long)n * threadId / numThreads);
+    int endNdx = (int)((long long)n * (threadId + 1) / numThreads);
+
+    while ((iterations < maxIterations) && ! converged) {
+        ++iterations;
+
+        while (true) {
+            if (threadId == 0) {
+                moreChunks = next_chunk();
+            }
+            synchronizeAllThreads();
+            if (! moreChunks) {
+                break;
+            }
+            assign_chunk(threadId);
+            synchronizeAllThreads();
+        }
+        if (readFailed) {
+            break;
+        }
+
+        if (threadId == 0) {
+            converged = ! move_centers();
+        }
+        synchronizeAllThreads();
+
+        if (! converged) {
+            update_bounds(startNdx, endNdx);
+        }
+        synchronizeAllThreads();
+    }
+
+    return iterations;
+}
+
+void StreamingKmeans::assign_chunk(int threadId) {
+    int first = chunkCount * threadId / numThreads;
+    int last = chunkCount * (threadId + 1) / numThreads;
+    double const *chunk = records[currentBuffer];
+
+    for (int r = first; r < last; ++r) {
+        int i = chunkStart + r;
+        double const *xp = chunk + r * d;
+        unsigned short closest = assignment[i];
+
+        if (closest != k) {
+            // Hamerly's tests, as in HamerlyKmeans
+            double bound = std::max(s[closest], getLower(i));
+            if (getUpper(i) <= bound) {
+                continue;
+            }
+            double u = sqrt(distance2(xp, centers->data + closest * d, d));
+            setUpper(i, u);
+            if (u <= bound) {
+                continue;
+            }
+        }
+
+        // look at all centers, taking the lowest index on ties (as Lloyd's
+        // algorithm does)
+        double closestDist2 = std::numeric_limits<double>::max();
+        double secondDist2 = std::numeric_limits<double>::max();
+        closest = 0;
+        for (int j = 0; j < k; ++j) {
+            double d2 = distance2(xp, centers->data + j * d, d);
+            if (d2 < closestDist2) {
+                secondDist2 = closestDist2;
+                closestDist2 = d2;
+                closest = j;
+            } else if (d2 < secondDist2) {
+                secondDist2 = d2;
+            }
+        }
+
+        setUpper(i, sqrt(closestDist2));
+        setLower(i, sqrt(secondDist2));
+
+        if (assignment[i] != closest) {
+            if (assignment[i] != k) {
+                --clusterSize[threadId][assignment[i]];
+                subVectors(sumNewCenters[threadId] + assignment[i] * d, xp, d);
+            }
+            ++clusterSize[threadId][closest];
+            addVectors(sumNewCenters[threadId] + closest * d, xp, d);
+            assignment[i] = closest;
+        }
+    }
+}
+
+bool StreamingKmeans::move_centers() {
+    bool moved = false;
+    for (int j = 0; j < k; ++j) {
+        centerMovement[j] = 0.0;
+        int totalClusterSize = 0;
+        for (int t = 0; t < numThreads; ++t) {
+            totalClusterSize += clusterSize[t][j];
+        }
+        if (totalClusterSize > 0) {
+            for (int dim = 0; dim < d; ++dim) {
+                double z = 0.0;
+                for (int t = 0; t < numThreads; ++t) {
+                    z += sumNewCenters[t][j * d + dim];
+                }
+                z /= totalClusterSize;
+                centerMovement[j] += (z - (*centers)(j, dim)) * (z - (*centers)(j, dim));
+                (*centers)(j, dim) = z;
+            }
+        }
+        centerMovement[j] = sqrt(centerMovement[j]);
+        moved = moved || (centerMovement[j] > 0.0);
+    }
+
+    for (int c1 = 0; c1 < k; ++c1) {
+        s[c1] = std::numeric_limits<double>::max();
+        for (int c2 = 0; c2 < k; ++c2) {
+            if (c2 != c1) {
+                s[c1] = std::min(s[c1], distance2(centers->data + c1 * d, centers->data + c2 * d, d));
+            }
+        }
+        s[c1] = sqrt(s[c1]) / 2.0;
+    }
+
+    return moved;
+}
+
+void StreamingKmeans::update_bounds(int startNdx, int endNdx) {
+    // the lower bound shrinks by the furthest movement of any center other
+    // than the assigned one
+    int furthest = (int)(std::max_element(centerMovement, centerMovement + k) - centerMovement);
+    double secondFurthest = 0.0;
+    for (int j = 0; j < k; ++j) {
+        if (j != furthest) {
+            secondFurthest = std::max(secondFurthest, centerMovement[j]);
+        }
+    }
+
+    for (int i = startNdx; i < endNdx; ++i) {
+        unsigned short a = assignment[i];
+        setUpper(i, getUpper(i) + centerMovement[a]);
+        setLower(i, getLower(i) - ((a == furthest) ? secondFurthest : centerMovement[furthest]));
+    }
+}
+
+bool StreamingKmeans::next_chunk() {
+    #ifdef USE_THREADS
+    pthread_mutex_lock(&bufferLock);
+    if (currentBuffer >= 0) {
+        full[currentBuffer] = false;
+        pthread_cond_broadcast(&bufferChanged);
+    }
+    while (! full[nextBuffer]) {
+        pthread_cond_wait(&bufferChanged, &bufferLock);
+    }
+    pthread_mutex_unlock(&bufferLock);
+    #else
+    buffered[nextBuffer] = source->next(buffer[nextBuffer], &records[nextBuffer]);
+    if (buffered[nextBuffer] <= 0) {
+        source->rewind();
+    }
+    #endif
+
+    chunkStart += chunkCount;
+    currentBuffer = nextBuffer;
+    nextBuffer = 1 - nextBuffer;
+    chunkCount = buffered[currentBuffer];
+
+    if (chunkCount <= 0) {
+        // the end of the pass (or a failed read, which ends the run); release
+        // the marker right away
+        readFailed = readFailed || (chunkCount < 0);
+        chunkCount = 0;
+        #ifdef USE_THREADS
+        pthread_mutex_lock(&bufferLock);
+        full[currentBuffer] = false;
+        pthread_cond_broadcast(&bufferChanged);
+        pthread_mutex_unlock(&bufferLock);
+        #endif
+        currentBuffer = -1;
+        chunkStart = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void *StreamingKmeans::reader(void *args) {
+    #ifdef USE_THREADS
+    StreamingKmeans *km = (StreamingKmeans *)args;
+    for (int b = 0; ; b = 1 - b) {
+        pthread_mutex_lock(&km->bufferLock);
+        while (km->full[b] && ! km->stopReading) {
+            pthread_cond_wait(&km->bufferChanged, &km->bufferLock);
+        }
+        bool stop = km->stopReading;
+        pthread_mutex_unlock(&km->bufferLock);
+        if (stop) {
+            break;
+        }
+
+        // a pass ends with an empty chunk, after which the next pass begins
+        km->buffered[b] = km->source->next(km->buffer[b], &km->records[b]);
+        if (km->buffered[b] <= 0) {
+            km->source->rewind();
+        }
+
+        pthread_mutex_lock(&km->bufferLock);
+        km->full[b] = true;
+        pthread_cond_broadcast(&km->bufferChanged);
+        pthread_mutex_unlock(&km->bufferLock);
+    }
+    #endif
+    return NULL;
+}
+
+double StreamingKmeans::getSSE() {
+    double sse = 0.0;
+    double const *chunk = NULL;
+    int first = 0, count;
+    source->rewind();
+    for (; (count = source->next(buffer[0], &chunk)) > 0; first += count) {
+        for (int r = 0; r < count; ++r) {
+            if (assignment[first + r] == k) {
+                source->rewind();
+                return -1.0;
+            }
+            sse += distance2(chunk + r * d, centers->data + assignment[first + r] * d, d);
+        }
+    }
+    source->rewind();
+    return (count < 0 || first < n) ? -1.0 : sse;
+}
+
+Dataset *StreamingKmeans::sample_centers(ChunkedDataset *source, unsigned short k) {
+    Dataset *c = new Dataset(k, source->d);
+    double *buf = new double[source->chunkSize * source->d];
+    double const *chunk = NULL;
+    int seen = 0;
+    int count;
+    source->rewind();
+    while ((count = source->next(buf, &chunk)) > 0) {
+        for (int r = 0; r < count; ++r, ++seen) {
+            int slot = (seen < k) ? seen : (int)(((double)rand() / ((double)RAND_MAX + 1.0)) * (seen + 1));
+            if (slot < k) {
+                std::copy(chunk + r * source->d, chunk + (r + 1) * source->d, c->data + slot * source->d);
+            }
+        }
+    }
+    source->rewind();
+    delete [] buf;
+    if (count < 0 || seen < k) {
+        delete c;
+        return NULL;
+    }
+    return c;
+}
@@ -0,0 +1,153 @@
+#ifndef STREAMING_KMEANS_H
+#define STREAMING_KMEANS_H
+
+/* Authors: Greg Hamerly and Jonathan Drake
+ * Feedback: hamerly@cs.baylor.edu
+ * See: http://cs.baylor.edu/~hamerly/software/kmeans.php
+ * Copyright 2014
+ *
+ * StreamingKmeans runs Lloyd's algorithm (with Hamerly's bounds) over a
+ * ChunkedDataset that is too large to keep in memory. Each iteration streams
+ * the file once, chunk by chunk; only the centers, their sufficient
+ * statistics, and each point's assignment and two bounds stay resident. The
+ * bounds can optionally be stored as floats (rounded conservatively), which
+ * halves their memory.
+ *
+ * When threads are enabled, a reader thread loads the next chunk into one
+ * buffer while the clustering threads work on the other, so that I/O overlaps
+ * computation.
+ *
+ * This does not derive from Kmeans, which requires the whole Dataset, but
+ * provides the same kind of interface. Starting from the same centers, it
+ * performs the same iterations as Lloyd's algorithm.
+ */
+
+#include "chunked_dataset.h"
+#include <limits>
+#include <string>
+#ifdef USE_THREADS
+    #include <pthread.h>
+#endif
+
+class StreamingKmeans {
+    public:
+        // If aCompressBounds is true, bounds are kept as floats.
+        StreamingKmeans(bool aCompressBounds = false);
+        ~StreamingKmeans() { free(); }
+
+        // Prepare to cluster the records of source, starting from the given
+        // centers. The source must stay open while this object is used.
+        void initialize(ChunkedDataset *aSource, Dataset const &initialCenters, int aNumThreads);
+        void free();
+
+        // Run until convergence (or maxIterations passes over the data), and
+        // return the number of iterations performed, or -1 if the source
+        // could not be read (in which case the clustering is incomplete).
+        int run(int maxIterations = std::numeric_limits<int>::max());
+
+        // Get the cluster assignment for the given point index.
+        int getAssignment(int xIndex) const { return assignment[xIndex]; }
+
+        // Compute the sum of squared errors, which takes another pass over the
+        // data. Returns -1 if the source could not be read or some point has
+        // not been assigned.
+        double getSSE();
+
+        Dataset const *getCenters() const { return centers; }
+        std::string getName() const { return compressBounds ? "streaming+float" : "streaming"; }
+
+        // Choose k records uniformly at random from source (by reservoir
+        // sampling, in one pass) to be initial centers. The source must have
+        // at least k records. Returns NULL if it does not, or it could not be
+        // read.
+        static Dataset *sample_centers(ChunkedDataset *source, unsigned short k);
+
+    private:
+        // This is where each clustering thread does its work.
+        int runThread(int threadId, int maxIterations);
+        static void *runner(void *args);
+
+        // Assign this thread's share of the current chunk.
+        void assign_chunk(int threadId);
+
+        // Move the centers to the means of their points, and compute s and how
+        // far the centers moved. Returns whether the centers moved.
+        bool move_centers();
+
+        // Update the bounds of points [startNdx, endNdx) after the centers
+        // have moved.
+        void update_bounds(int startNdx, int endNdx);
+
+        // Wait for the next chunk and make it current (releasing the previous
+        // one). Returns false at the end of a pass over the data, or if the
+        // chunk could not be read (setting readFailed).
+        bool next_chunk();
+
+        // The reader thread, which fills the chunk buffers in turn.
+        static void *reader(void *args);
+
+        // Bound accessors; stores round conservatively when compressing.
+        double getUpper(int i) const { return compressBounds ? (double)upperF[i] : upperD[i]; }
+        double getLower(int i) const { return compressBounds ? (double)lowerF[i] : lowerD[i]; }
+        void setUpper(int i, double value);
+        void setLower(int i, double value);
+
+        void synchronizeAllThreads() {
+            #ifdef USE_THREADS
+            pthread_barrier_wait(&barrier);
+            #endif
+        }
+
+        ChunkedDataset *source;
+        int n, k, d, numThreads;
+        bool compressBounds;
+
+        Dataset *centers;
+
+        // For each thread, the sum and count of the points assigned to each
+        // center.
+        double **sumNewCenters;
+        int **clusterSize;
+
+        // How far each center moved in the last iteration, and half the
+        // distance from each center to its closest other center.
+        double *centerMovement;
+        double *s;
+
+        // Each point's assignment (k if not yet assigned), and its upper and
+        // lower bounds, stored either as doubles or as floats.
+        unsigned short *assignment;
+        double *upperD, *lowerD;
+        float *upperF, *lowerF;
+
+        // To communicate (to all threads) that we have converged, that the
+        // current pass has another chunk, and that a chunk could not be read.
+        bool converged, moreChunks, readFailed;
+
+        // The chunk buffers. buffered[b] is the number of records in buffer b
+        // (0 marks the end of a pass, and -1 a failed read) and records[b] points to them; full[b]
+        // says whether buffer b has been filled and not yet released.
+        double *buffer[2];
+        double const *records[2];
+        int buffered[2];
+        bool full[2];
+
+        // The chunk being worked on: its buffer (-1 if none), the index of
+        // its first record, and its number of records; and the buffer that
+        // will hold the next chunk.
+        int currentBuffer, chunkStart, chunkCount, nextBuffer;
+
+        #ifdef USE_THREADS
+        pthread_barrier_t barrier;
+        pthread_t readerThread;
+        pthread_mutex_t bufferLock;
+        pthread_cond_t bufferChanged;
+        bool stopReading;
+        #endif
+
+        // Disallow copies.
+        StreamingKmeans(StreamingKmeans const &);
+        StreamingKmeans const &operator=(StreamingKmeans const &);
+};
+
+#endif
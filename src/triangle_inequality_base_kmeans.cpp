@@ -15,9 +15,11 @@ void TriangleInequalityBaseKmeans::free() {
     delete [] s;
     delete [] upper;
     delete [] lower;
+    delete centerIndex;
     s = NULL;
     upper = NULL;
     lower = NULL;
+    centerIndex = NULL;
 }
 
 /* This function computes the inter-center distances, keeping only the closest
@@ -68,12 +70,34 @@ void TriangleInequalityBaseKmeans::initialize(Dataset const *aX, unsigned short
 
     s = new double[k];
     upper = new double[n];
-    lower = new double[n * numLowerBounds];
 
     // start with invalid bounds and assignments which will force the first
     // iteration of k-means to do all its standard work 
     std::fill(s, s + k, 0.0);
     std::fill(upper, upper + n, std::numeric_limits<double>::max());
-    std::fill(lower, lower + n * numLowerBounds, 0.0);
+
+    if (seedDistances != NULL && numLowerBounds == k) {
+        // the distances to all initial centers are the lower bounds, which
+        // seed_bounds() brings up to date
+        lower = seedDistances;
+        seedDistances = NULL;
+    } else {
+        lower = new double[n * numLowerBounds];
+        std::fill(lower, lower + n * numLowerBounds, 0.0);
+    }
+
+    if (useCenterIndex) {
+        centerIndex = new NearCenterIndex;
+        centerIndex->initialize(centers, numThreads);
+    }
+}
+
+int TriangleInequalityBaseKmeans::find_nearest_centers(int i, int m, double radius2, std::pair<double, int> *result, int threadId) const {
+    int found = centerIndex->nearest(x->data + i * d, m, radius2, result, threadId);
+    #ifdef COUNT_DISTANCES
+    numDistances += centerIndex->numDistances;
+    centerIndex->numDistances = 0;
+    #endif
+    return found;
 }
 
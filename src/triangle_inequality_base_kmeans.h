@@ -11,18 +11,38 @@
  */
 
 #include "original_space_kmeans.h"
+#include "near_center_index.h"
 
 class TriangleInequalityBaseKmeans : public OriginalSpaceKmeans {
     public:
-        TriangleInequalityBaseKmeans() : numLowerBounds(0), s(NULL), upper(NULL), lower(NULL) {}
+        TriangleInequalityBaseKmeans() : numLowerBounds(0), s(NULL), upper(NULL), lower(NULL),
+            useCenterIndex(false), centerIndex(NULL) {}
         virtual ~TriangleInequalityBaseKmeans() { free(); }
 
+        using Kmeans::initialize;
         virtual void initialize(Dataset const *aX, unsigned short aK, unsigned short *initialAssignment, int aNumThreads);
         virtual void free();
 
+        // Whether to search a NearCenterIndex over the centers, instead of
+        // scanning all k centers, when a point's bounds fail. This takes
+        // effect at the next initialize(), and only for algorithms that
+        // support it (currently Hamerly, Annulus and Drake).
+        void setUseCenterIndex(bool aUseCenterIndex) { useCenterIndex = aUseCenterIndex; }
+
     protected:
         void update_s(int threadId);
 
+        // Find the m nearest centers to point i using the centerIndex (see
+        // NearCenterIndex::nearest()).
+        int find_nearest_centers(int i, int m, double radius2, std::pair<double, int> *result, int threadId) const;
+
+        // Bring the centerIndex (if any) up to date after move_centers().
+        void update_center_index() {
+            if (centerIndex) {
+                centerIndex->update(centerMovement);
+            }
+        }
+
         // The number of lower bounds being used by this algorithm.
         int numLowerBounds;
 
@@ -37,6 +57,11 @@ class TriangleInequalityBaseKmeans : public OriginalSpaceKmeans {
         // the centers being tracked for lower bounds, which may be 1 to k.
         // Actual size is n * numLowerBounds.
         double *lower;
+
+        // Whether to use the centerIndex, and the index itself (which is NULL
+        // when not in use).
+        bool useCenterIndex;
+        NearCenterIndex *centerIndex;
 };
 
 #endif